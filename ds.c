@@ -1,7 +1,33 @@
 // Let ds(n) be the smallest prime number where the digit sums of it written in bases 2 to n+1 are all prime.
 // this program finds ds(n)
-// Usage: ds start end minbase maxbase
+// Usage: ds [-a] [-m] [-t threads] [-k kernel] [-f tablefile] [-c checkpoint] [-j report] [-l ledger] [-b board]
+//           start end minbase maxbase
+//        ds -l ledger -q query [size]
+//        ds -B
+//        ds --scaling [-k kernel] [-j report] [threads ...]
 // Where:
+//     -a         - all records: sweep from base 2 whatever minbase is, reporting the first value in the
+//                  range whose digit sums are prime in every base from 2 to k for each k up to maxbase
+//     -B         - microbenchmark: time each kernel on fixed inputs (ns/op and cycles/op)
+//     --scaling  - scaling benchmark: time a fixed search per thread on each number of threads given
+//                  (default 1, 2, 4... up to the cores then every logical CPU) one thread per core
+//                  before SMT siblings, reporting throughput and parallel efficiency (JSON with -j)
+//     -m         - metrics: count how many candidates reach each check of the kernels and
+//                  how many each radix rejects (the search runs a copy of the kernels counting them)
+//     threads    - number of search threads (default 1)
+//     kernel     - auto, scalar, vector, batch, lowbit or sieve (default auto which times them for each base)
+//     tablefile  - digit sum table file shared by every process that maps it (built if missing)
+//     checkpoint - file the search progress is saved to periodically and on SIGINT/SIGTERM
+//                  (the search resumes from it if it exists and is removed when the search completes)
+//     report     - file a JSON report of the completed search is written to
+//     ledger     - ledger of completed searches the search is appended to when it completes
+//     board      - board shared by every search posting the smallest value found for each radix
+//                  so searches above a value found elsewhere move straight on to the next radix
+//     status     - status page each search thread publishes its position, radix, rate and hits to
+//                  (a file dashboards can map) with a Prometheus text copy written to status.prom
+//     query      - next size (first block of size values not searched), best (smallest value for
+//                  each n), ranges (ranges searched) or watch (best redisplayed as searches complete)
+//                  answered from the ledger
 //     start   - starting search value
 //     end     - end search value
 //     minbase - minimum n+1
@@ -12,37 +38,82 @@
 // Uses fast 64bit prime number checking code
 // which is Copyright (c) 2014 Colin Percival.
 // See below for license.
+// It has been adapted to use Montgomery multiplication and the Baillie-PSW test.
 
 
-// header files
+// header files (thread affinity needs the GNU extensions)
+#define _GNU_SOURCE
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <nmmintrin.h>
+#include <immintrin.h>
 #include <math.h>
 #include <stdint.h>
 #include <limits.h>
 #include <stdbool.h>
 #include <locale.h>
-#include <sys/time.h>
-
-
-// metrics (enabled if compiled with -DMETRICS)
-#ifdef METRICS
-static uint64_t checks = 0;
-static uint64_t gate2 = 0;
-static uint64_t gate4 = 0;
-static uint64_t gate8 = 0;
-static uint64_t gate16 = 0;
-static uint64_t gate32 = 0;
-static uint64_t sums = 0;
-static uint64_t primes = 0;
-static uint64_t sub16 = 0;
-static uint64_t plus16 = 0;
-static uint64_t plus32 = 0;
-#define METRIC(x) x++;
-#else
-#define METRIC(x)
-#endif
+#include <unistd.h>
+#include <pthread.h>
+#include <sched.h>
+#include <getopt.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/file.h>
+#include <sys/inotify.h>
+#include <fcntl.h>
+#include <time.h>
+#include <signal.h>
+
+
+// search funnel for one of the kernels, the number of candidates reaching each check
+typedef struct {
+    uint64_t checks;    // candidates checked
+    uint64_t gate2;     // passed the base 2 check
+    uint64_t gate4;     // passed the base 4 check
+    uint64_t gate8;     // passed the base 8 check
+    uint64_t gate16;    // passed the base 16 check
+    uint64_t gate32;    // passed the base 32 check
+    uint64_t wheel;     // on the wheel (only the low bit kernels check it after the power of 2 radices)
+    uint64_t quick;     // passed every quick check the kernel makes for the radix
+    uint64_t sums;      // digit sums prime in every base
+    uint64_t primes;    // prime with every digit sum prime
+} Funnel;
+
+
+// first funnel of each kernel (the scalar kernels have one each and the other kernels have one for
+// each of their gate limits, radix 3, 4-7, 8-15, 16-31 and 32+, so every candidate in a funnel goes
+// through the same gates)
+#define FUNNEL_SUB16 0
+#define FUNNEL_16TO31 1
+#define FUNNEL_32PLUS 2
+#define FUNNEL_VECTOR 3
+#define FUNNEL_BATCH 8
+#define FUNNEL_LOWBIT 13
+#define FUNNEL_SIEVE 18
+#define FUNNELS 23
+#define FUNNEL_GATES 5
+
+
+// metrics for a search thread (added to the totals after each chunk)
+// aligned to a cache line so no two threads ever write to the same line
+typedef struct {
+    Funnel funnel[FUNNELS];
+} __attribute__((aligned(64))) Metrics;
+
+
+// metrics are counted when the search is run with -m
+static bool metricsEnabled = false;
+
+
+// metrics for the current thread
+static _Thread_local Metrics threadMetrics;
+
+
+// count a metric in the copy of a kernel built with metrics (compiled out of the copy without)
+#define METRIC(x) if (metrics) { funnel->x++; }
+#define METRIC_ADD(x, n) if (metrics) { funnel->x += (n); }
 
 
 /*-
@@ -75,41 +146,88 @@ static uint64_t plus32 = 0;
 #include <stddef.h>
 
 
-/* Return a * b % n, where 0 < n. */
-static uint64_t
-mulmod(uint64_t a, uint64_t b, uint64_t n)
+/*
+ * The modular arithmetic below works in Montgomery form so each multiply
+ * is a pair of 64x64->128 bit multiplies instead of a bit-serial loop.
+ * A value x is held as x * 2^64 mod n and n must be odd.
+ */
+
+/* Modulus and constants for Montgomery arithmetic modulo n. */
+typedef struct {
+    uint64_t n;     /* odd modulus */
+    uint64_t ninv;  /* n^-1 mod 2^64 */
+    uint64_t one;   /* 1 in Montgomery form (2^64 mod n) */
+    uint64_t r2;    /* 2^128 mod n, used to convert into Montgomery form */
+} montgomery;
+
+/* Initialise Montgomery constants for odd n. */
+static void
+montinit(montgomery *m, uint64_t n)
 {
-    uint64_t x = 0;
-    uint64_t an = a % n;
+    uint64_t x = n;
+    int i;
 
-    while (b != 0) {
-        if (b & 1) {
-            x += an;
-            if ((x < an) || (x >= n))
-                x -= n;
-        }
-        if (an + an < an)
-            an = an + an - n;
-        else if (an + an >= n)
-            an = an + an - n;
-        else
-            an = an + an;
-        b >>= 1;
-    }
+    /* Newton iteration doubles the correct low bits each step (3 to 96). */
+    for (i = 0; i < 5; i++)
+        x *= 2 - n * x;
 
-    return (x);
+    m->n = n;
+    m->ninv = x;
+    m->one = (0 - n) % n;
+    m->r2 = (uint64_t)(((unsigned __int128)m->one << 64) % n);
+}
+
+/* Return a * b / 2^64 % n, where a, b < n. */
+static inline uint64_t
+mulmod(uint64_t a, uint64_t b, const montgomery *m)
+{
+    unsigned __int128 t = (unsigned __int128)a * b;
+    uint64_t lo = (uint64_t)t;
+    uint64_t hi = (uint64_t)(t >> 64);
+    uint64_t q = (uint64_t)(((unsigned __int128)(lo * m->ninv) * m->n) >> 64);
+
+    /* The low halves cancel exactly so only the high halves are needed. */
+    return (hi < q) ? hi - q + m->n : hi - q;
+}
+
+/* Return a + b % n, where a, b < n. */
+static inline uint64_t
+addmod(uint64_t a, uint64_t b, uint64_t n)
+{
+    return (a >= n - b) ? a - (n - b) : a + b;
+}
+
+/* Return a - b % n, where a, b < n. */
+static inline uint64_t
+submod(uint64_t a, uint64_t b, uint64_t n)
+{
+    return (a < b) ? a - b + n : a - b;
+}
+
+/* Return a / 2 % n, where a < n and n is odd. */
+static inline uint64_t
+halfmod(uint64_t a, uint64_t n)
+{
+    return (a & 1) ? (a >> 1) + (n >> 1) + 1 : a >> 1;
+}
+
+/* Convert a < n into Montgomery form. */
+static inline uint64_t
+tomont(uint64_t a, const montgomery *m)
+{
+    return mulmod(a, m->r2, m);
 }
 
-/* Return a^r % n, where 0 < n. */
+/* Return a^r % n in Montgomery form, where a is in Montgomery form. */
 static uint64_t
-powmod(uint64_t a, uint64_t r, uint64_t n)
+powmod(uint64_t a, uint64_t r, const montgomery *m)
 {
-    uint64_t x = 1;
+    uint64_t x = m->one;
 
     while (r != 0) {
         if (r & 1)
-            x = mulmod(a, x, n);
-        a = mulmod(a, a, n);
+            x = mulmod(a, x, m);
+        a = mulmod(a, a, m);
         r >>= 1;
     }
 
@@ -118,28 +236,28 @@ powmod(uint64_t a, uint64_t r, uint64_t n)
 
 /* Return non-zero if n is a strong pseudoprime to base p. */
 static int
-spsp(uint64_t n, uint64_t p)
+spsp(const montgomery *m, uint64_t p)
 {
+    uint64_t n = m->n;
+    uint64_t minus1 = n - m->one;
     uint64_t x;
     uint64_t r = n - 1;
     int k = 0;
 
     /* Compute n - 1 = 2^k * r. */
-    while ((r & 1) == 0) {
-        k++;
-        r >>= 1;
-    }
+    k = __builtin_ctzll(r);
+    r >>= k;
 
     /* Compute x = p^r mod n.  If x = 1, n is a p-spsp. */
-    x = powmod(p, r, n);
-    if (x == 1)
+    x = powmod(tomont(p % n, m), r, m);
+    if (x == m->one)
         return (1);
 
-    /* Compute x^(2^i) for 0 <= i < n.  If any are -1, n is a p-spsp. */
+    /* Compute x^(2^i) for 0 <= i < k.  If any are -1, n is a p-spsp. */
     while (k > 0) {
-        if (x == n - 1)
+        if (x == minus1)
             return (1);
-        x = powmod(x, 2, n);
+        x = mulmod(x, x, m);
         k--;
     }
 
@@ -147,100 +265,145 @@ spsp(uint64_t n, uint64_t p)
     return (0);
 }
 
-/* Test for primality using strong pseudoprime tests. */
-int
-isPrime(uint64_t _n)
+/* Return the Jacobi symbol (a/n), where n is odd. */
+static int
+jacobi(uint64_t a, uint64_t n)
 {
-    uint64_t n = _n;
+    uint64_t t;
+    int j = 1;
+
+    a %= n;
+    while (a != 0) {
+        while ((a & 1) == 0) {
+            a >>= 1;
+            if ((n & 7) == 3 || (n & 7) == 5)
+                j = -j;
+        }
+        t = a;
+        a = n;
+        n = t;
+        if ((a & 3) == 3 && (n & 3) == 3)
+            j = -j;
+        a %= n;
+    }
 
-    /*
-     * Values from:
-     * C. Pomerance, J.L. Selfridge, and S.S. Wagstaff, Jr.,
-     * The pseudoprimes to 25 * 10^9, Math. Comp. 35(151):1003-1026, 1980.
-     */
+    return ((n == 1) ? j : 0);
+}
 
-    /* No SPSPs to base 2 less than 2047. */
-    if (!spsp(n, 2))
-        return (0);
-    if (n < 2047ULL)
-        return (1);
+/* Return non-zero if n is a perfect square. */
+static int
+issquare(uint64_t n)
+{
+    uint64_t r = (uint64_t)sqrt((double)n);
 
-    /* No SPSPs to bases 2,3 less than 1373653. */
-    if (!spsp(n, 3))
-        return (0);
-    if (n < 1373653ULL)
-        return (1);
+    /* Correct any rounding in the floating point square root. */
+    while (r > 0xFFFFFFFFULL || r * r > n)
+        r--;
+    while (r < 0xFFFFFFFFULL && (r + 1) * (r + 1) <= n)
+        r++;
 
-    /* No SPSPs to bases 2,3,5 less than 25326001. */
-    if (!spsp(n, 5))
-        return (0);
-    if (n < 25326001ULL)
-        return (1);
+    return (r * r == n);
+}
 
-    /* No SPSPs to bases 2,3,5,7 less than 3215031751. */
-    if (!spsp(n, 7))
-        return (0);
-    if (n < 3215031751ULL)
-        return (1);
+/*
+ * Return non-zero if n is a strong Lucas probable prime using Selfridge's
+ * parameters: the first D in 5, -7, 9, -11, ... with (D/n) = -1, P = 1 and
+ * Q = (1 - D) / 4.  Requires n odd, not a perfect square and n > 3.
+ */
+static int
+lucas(const montgomery *m)
+{
+    uint64_t n = m->n;
+    uint64_t d = n + 1;
+    uint64_t u, v, qk, dm, qm, ut;
+    int64_t D = 5;
+    int s, j, bit;
+
+    /* Find D with (D/n) = -1. */
+    for (;;) {
+        j = jacobi((D > 0) ? (uint64_t)D : n - ((uint64_t)-D % n), n);
+        if (j == -1)
+            break;
+        if (j == 0 && (uint64_t)((D > 0) ? D : -D) != n)
+            return (0);
+        D = (D > 0) ? -(D + 2) : -D + 2;
+    }
 
-    /*
-     * Values from:
-     * G. Jaeschke, On strong pseudoprimes to several bases,
-     * Math. Comp. 61(204):915-926, 1993.
-     */
+    /* Constants D and Q = (1 - D) / 4 in Montgomery form. */
+    dm = tomont((D > 0) ? (uint64_t)D % n : n - ((uint64_t)-D % n), m);
+    qm = ((1 - D) / 4 > 0) ? tomont((uint64_t)((1 - D) / 4) % n, m) :
+        submod(0, tomont((uint64_t)(-((1 - D) / 4)) % n, m), n);
+
+    /* Compute n + 1 = 2^s * d. */
+    s = __builtin_ctzll(d);
+    d >>= s;
+
+    /* Compute U_d, V_d and Q^d from the top bit of d down (U_1 = 1, V_1 = P = 1). */
+    u = m->one;
+    v = m->one;
+    qk = qm;
+    for (bit = 62 - __builtin_clzll(d); bit >= 0; bit--) {
+        /* U_2k = U_k V_k, V_2k = V_k^2 - 2 Q^k, Q^2k = (Q^k)^2 */
+        u = mulmod(u, v, m);
+        v = submod(mulmod(v, v, m), addmod(qk, qk, n), n);
+        qk = mulmod(qk, qk, m);
+        if ((d >> bit) & 1) {
+            /* U_2k+1 = (U_2k + V_2k) / 2, V_2k+1 = (D U_2k + V_2k) / 2 */
+            ut = halfmod(addmod(u, v, n), n);
+            v = halfmod(addmod(mulmod(dm, u, m), v, n), n);
+            u = ut;
+            qk = mulmod(qk, qm, m);
+        }
+    }
 
-    /* No SPSPs to bases 2,3,5,7,11 less than 2152302898747. */
-    if (!spsp(n, 11))
-        return (0);
-    if (n < 2152302898747ULL)
+    /* Strong test: U_d = 0 or V_(d*2^r) = 0 for some 0 <= r < s. */
+    if (u == 0 || v == 0)
         return (1);
+    while (--s > 0) {
+        v = submod(mulmod(v, v, m), addmod(qk, qk, n), n);
+        if (v == 0)
+            return (1);
+        qk = mulmod(qk, qk, m);
+    }
 
-    /* No SPSPs to bases 2,3,5,7,11,13 less than 3474749660383. */
-    if (!spsp(n, 13))
-        return (0);
-    if (n < 3474749660383ULL)
-        return (1);
+    /* Not a strong Lucas probable prime. */
+    return (0);
+}
 
-    /* No SPSPs to bases 2,3,5,7,11,13,17 less than 341550071728321. */
-    if (!spsp(n, 17))
-        return (0);
-    if (n < 341550071728321ULL)
-        return (1);
+/*
+ * Test for primality using the Baillie-PSW test: a strong pseudoprime test
+ * to base 2 followed by a strong Lucas test.  There are no Baillie-PSW
+ * pseudoprimes less than 2^64 so the result is exact for every 64-bit value.
+ *
+ * Values from:
+ * J. Feitsma and W. Galway, Tables of pseudoprimes to base 2, 2013.
+ */
+int
+isPrime(uint64_t n)
+{
+    static const uint8_t small[] = { 2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47, 53 };
+    montgomery m;
+    size_t i;
 
-    /* No SPSPs to bases 2,3,5,7,11,13,17,19 less than 341550071728321. */
-    if (!spsp(n, 19))
+    /* Trial division by small primes handles every n < 59^2. */
+    if (n < 2)
         return (0);
-    if (n < 341550071728321ULL)
+    for (i = 0; i < sizeof(small); i++) {
+        if (n % small[i] == 0)
+            return (n == small[i]);
+    }
+    if (n < 3481ULL)
         return (1);
 
-    /*
-     * Value from:
-     * Y. Jiang and Y. Deng, Strong pseudoprimes to the first eight prime
-     * bases, Math. Comp. 83(290):2915-2924, 2014.
-     */
-
-    /* No SPSPs to bases 2..23 less than 3825123056546413051. */
-    if (!spsp(n, 23))
+    /* Strong pseudoprime test to base 2. */
+    montinit(&m, n);
+    if (!spsp(&m, 2))
         return (0);
-    if (n < 3825123056546413051)
-        return (1);
 
-    /*
-     * Value from:
-     * J. Sorenson and J. Webster, Strong pseudoprimes to twelve prime
-     * bases, Math. Comp. 86(304):985-1003, 2017.
-     */
-
-    /* No SPSPs to bases 2..37 less than 318665857834031151167461. */
-    if (!spsp(n, 29))
-        return (0);
-    if (!spsp(n, 31))
+    /* Strong Lucas test (perfect squares have no D with (D/n) = -1). */
+    if (issquare(n))
         return (0);
-    if (!spsp(n, 37))
-        return (0);
-
-    /* All 64-bit values are less than 318665857834031151167461. */
-    return (1);
+    return (lucas(&m));
 }
 
 
@@ -248,10 +411,91 @@ isPrime(uint64_t _n)
 static bool *smallprimes = NULL;
 
 
-// lookup arrays for 4 digit sums by radix
+// bitmap of which digit sums below 512 are prime for the vector gates
+static uint64_t smallprimeBits[8];
+
+
+// lookup arrays for digit sums of a group of digits by radix
 static uint8_t **digitSumLookup = NULL;
 
 
+// bytes of digit sum lookup arrays allocated or mapped
+static uint64_t digitSumBytes = 0;
+
+
+// reciprocal for dividing by a runtime constant using a multiply and shifts instead of a hardware divide
+// (the method used by libdivide: a 64 bit multiplier where one exists, otherwise a 65 bit one
+// whose top bit is handled with an add)
+typedef struct {
+    uint64_t divisor;   // the divisor
+    uint64_t magic;     // multiplier
+    uint8_t preshift;   // trailing zero bits of the divisor removed from the value first
+    uint8_t shift;      // shift applied to the high half of the product
+    bool add;           // whether the multiplier has an implied 65th bit
+} Divider;
+
+
+// reciprocals for the lookup array size by radix (dividing by radix^digits)
+static Divider digitSumDivider[51];
+
+
+// initialise a reciprocal for the given divisor (which must be > 1)
+void initDivider(Divider *divider, const uint64_t divisor) {
+    uint64_t odd = divisor >> __builtin_ctzll(divisor);
+    uint32_t bits = 64 - __builtin_ctzll(divisor);
+    uint32_t log2 = 64 - __builtin_clzll(odd - 1);
+    unsigned __int128 magic = 0;
+    unsigned __int128 error = 0;
+
+    divider->divisor = divisor;
+
+    // a power of two is just a shift (taking the last bit with a multiplier of 2^63)
+    if (odd == 1) {
+        divider->magic = 1UL << 63;
+        divider->preshift = __builtin_ctzll(divisor) - 1;
+        divider->shift = 0;
+        divider->add = false;
+        return;
+    }
+
+    // look for the smallest shift with a 64 bit multiplier ceil(2^(64+shift) / odd) whose
+    // rounding error is small enough to be exact for every value of the remaining bits
+    for (uint32_t shift = 0; shift <= log2; shift++) {
+        magic = ((((unsigned __int128)1) << (64 + shift)) + odd - 1) / odd;
+        error = magic * odd - (((unsigned __int128)1) << (64 + shift));
+        if ((magic >> 64) == 0 && error <= (((unsigned __int128)1) << (shift + 64 - bits))) {
+            divider->magic = (uint64_t)magic;
+            divider->preshift = 64 - bits;
+            divider->shift = shift;
+            divider->add = false;
+            return;
+        }
+    }
+
+    // otherwise use the 65 bit multiplier 2^64 * (2^log2 - divisor) / divisor + 1 + 2^64
+    divider->magic = (uint64_t)((((unsigned __int128)((1UL << log2) - divisor)) << 64) / divisor) + 1;
+    divider->preshift = 0;
+    divider->shift = log2 - 1;
+    divider->add = true;
+}
+
+
+// divide using a reciprocal
+// Note: the quotient is exact for every 64 bit value
+static inline uint64_t divide(uint64_t value, const Divider *divider) {
+    uint64_t t = 0;
+
+    if (divider->add) {
+        t = (uint64_t)(((unsigned __int128)value * divider->magic) >> 64);
+        return (((value - t) >> 1) + t) >> divider->shift;
+    }
+
+    value >>= divider->preshift;
+    t = (uint64_t)(((unsigned __int128)value * divider->magic) >> 64);
+    return t >> divider->shift;
+}
+
+
 // compute the digit sum of the given value in the given radix
 uint64_t sumDigits(uint64_t value, const uint32_t radix) {
     // zero the sum
@@ -270,1349 +514,5003 @@ uint64_t sumDigits(uint64_t value, const uint32_t radix) {
 }
 
 
-// initialise 4 digit sum lookup array
-void initDigitSums(const uint32_t maxRadix, const uint32_t digits) {
-    uint32_t i, j, r, arraySize;
-    uint8_t *current = NULL;
-    uint64_t allocated = 0;
+// largest radix that can have its digits packed into bit fields
+#define PACKED_MAX_RADIX 7
+
+// largest step between values for which radix 5, 6 and 7 use their packed digits
+#define PACKED_MAX_STEP 30
+
+
+// layout of the digits of a radix packed into bit fields of two 64 bit words (2 bits per digit for
+// radix 3 and 3 bits per digit for radix 5, 6 and 7) so digit sums come from masked popcounts like
+// the power of 2 radices
+typedef struct {
+    uint32_t bits;          // bits per digit (0 if the radix is not packed)
+    uint32_t digits;        // digits in each word
+    uint32_t groupDigits;   // digits converted per lookup
+    uint64_t ones;          // lowest bit of each digit field
+    uint64_t bias;          // 2^bits - radix in each digit field so a digit reaching radix carries
+    Divider word;           // radix^digits (the weight of the high word)
+    Divider group;          // radix^groupDigits
+    uint16_t *lookup;       // packed digits for each value below radix^groupDigits
+} PackedRadix;
+
+
+// packed digit layouts by radix
+static PackedRadix packedRadix[PACKED_MAX_RADIX + 1];
+
+
+// initialise the packed digit layout for the radices 3, 5, 6 and 7
+void initPackedDigits(const uint32_t maxRadix) {
+    uint64_t power = 0;
+    uint32_t i, j, r, field;
+    PackedRadix *packed = NULL;
+
+    for (r = 3; r <= maxRadix && r <= PACKED_MAX_RADIX; r++) {
+        // skip power of 2 radices since the popcount gates already cover them
+        if ((r & (r - 1)) == 0) continue;
+
+        // radix 3 digits fit in 2 bits and use all 64 bits, the others fit in 3 bits and use 63
+        packed = &packedRadix[r];
+        packed->bits = (r == 3) ? 2 : 3;
+        packed->digits = 64 / packed->bits;
+        packed->groupDigits = (r == 3) ? 4 : 3;
+        packed->ones = 0;
+        packed->bias = 0;
+        for (field = 0; field < packed->digits; field++) {
+            packed->ones |= 1UL << (field * packed->bits);
+            packed->bias |= (uint64_t)((1U << packed->bits) - r) << (field * packed->bits);
+        }
 
-    // allocate the array of lookup arrays
-    digitSumLookup = (uint8_t **)malloc((maxRadix  + 1) * sizeof(uint8_t *));
-    if (digitSumLookup) {
-        // keep track of allocation size
-        allocated = (maxRadix  + 1) * sizeof(uint8_t *);
-
-        // for each radix
-        for (r = 2; r <= maxRadix; r++) {
-            // allocate the lookup array
-            arraySize = r;
-            for (j = 1; j < digits; j++) {
-                arraySize *= r;
-            }
-            if ((digitSumLookup[r] = (uint8_t *)malloc(arraySize * sizeof(uint8_t)))) {
-                // keep track of allocation size
-                allocated += arraySize * sizeof(uint8_t);
-
-                // populate the array
-                current = digitSumLookup[r];
-                for (i = 0; i < arraySize; i++) {
-                    *current++ = sumDigits(i, r);
-                }
-            } else {
-                fprintf(stderr, "Fatal: malloc failed for subarray\n");
-                exit(EXIT_FAILURE);
+        // dividers for splitting a value into words and groups
+        power = 1;
+        for (j = 0; j < packed->digits; j++) {
+            power *= r;
+        }
+        initDivider(&packed->word, power);
+        power = 1;
+        for (j = 0; j < packed->groupDigits; j++) {
+            power *= r;
+        }
+        initDivider(&packed->group, power);
+
+        // packed digits for each group value
+        if (!(packed->lookup = (uint16_t *)malloc(power * sizeof(uint16_t)))) {
+            fprintf(stderr, "Fatal: malloc failed for packed digits\n");
+            exit(EXIT_FAILURE);
+        }
+        for (i = 0; i < power; i++) {
+            packed->lookup[i] = 0;
+            for (j = 0, field = i; j < packed->groupDigits; j++, field /= r) {
+                packed->lookup[i] |= (field % r) << (j * packed->bits);
             }
         }
+    }
+}
+
+
+// free the packed digit layouts
+void freePackedDigits() {
+    for (uint32_t r = 0; r <= PACKED_MAX_RADIX; r++) {
+        free(packedRadix[r].lookup);
+        packedRadix[r].lookup = NULL;
+        packedRadix[r].bits = 0;
+    }
+}
+
+
+// pack the digits of a value that fits in one word
+static inline uint64_t packDigits(uint64_t value, const PackedRadix *packed) {
+    const uint64_t group = packed->group.divisor;
+    const uint32_t shift = packed->groupDigits * packed->bits;
+    uint64_t word = 0;
+    uint64_t dividor = 0;
+    uint32_t position = 0;
+
+    // small values (such as the steps between candidates) are a single lookup
+    if (value < group) {
+        return packed->lookup[value];
+    }
+
+    while (value) {
+        dividor = divide(value, &packed->group);
+        word |= (uint64_t)packed->lookup[value - (dividor * group)] << position;
+        position += shift;
+        value = dividor;
+    }
+
+    return word;
+}
+
+
+// add two words of packed digits using SWAR carry propagation and return the carry out of the top digit
+// Note: the bias makes a digit that reaches the radix carry into the next field in binary, and is then
+//       removed again from each field that did not carry
+static inline uint64_t addPackedDigits(uint64_t *word, const uint64_t value, const PackedRadix *packed) {
+    const uint64_t biased = *word + packed->bias;
+    uint64_t sum = biased + value;
+    uint64_t carries = (biased ^ value ^ sum) >> packed->bits;
+    uint64_t carry = 0;
+
+    // carry out of the top field (out of bit 63 for radix 3, into bit 63 for the others)
+    if (packed->bits == 2) {
+        carry = sum < biased;
     } else {
-        fprintf(stderr, "Fatal: malloc failed for array\n");
-        exit(EXIT_FAILURE);
+        carry = sum >> 63;
+        sum &= ~(1UL << 63);
     }
+    carries |= carry << ((packed->digits - 1) * packed->bits);
 
-    // display allocation size
-    printf("Lookup cache for %u digit sums for radix 2 to %u = %'lu bytes\n", digits, maxRadix, allocated);
+    // remove the bias from the fields that did not carry
+    *word = sum - ((packed->ones & ~carries) * (packed->bias & ((1U << packed->bits) - 1)));
+    return carry;
 }
 
 
-// free 4 digit sum lookup array
-void freeDigitSums(uint32_t maxRadix) {
-    // check if the array is allocated
-    if (digitSumLookup) {
-        // check each subarray
-        for (uint32_t r = 2; r <= maxRadix; r++) {
-            // check if the subarray is allocated
-            if (digitSumLookup[r]) {
-                // free the subarray
-                free(digitSumLookup[r]);
-                digitSumLookup[r] = NULL;
-            }
+// digit sum of a word of packed digits
+static inline uint32_t sumPackedDigits(const uint64_t word, const PackedRadix *packed) {
+    uint32_t sum = _mm_popcnt_u64(word & packed->ones);
+    sum += _mm_popcnt_u64(word & (packed->ones << 1)) << 1;
+    if (packed->bits == 3) {
+        sum += _mm_popcnt_u64(word & (packed->ones << 2)) << 2;
+    }
+    return sum;
+}
+
+
+// number of digits summed by each lookup array by radix
+static uint32_t digitSumDigits[51];
+
+
+// return the monotonic clock in nanoseconds
+static inline uint64_t monotonicNanos(void) {
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000UL + now.tv_nsec;
+}
+
+
+// populate a digit sum lookup array of the given size (a multiple of the radix) using
+// sum(i) = sum(i / radix) + i % radix so each entry costs an add rather than a division loop
+static void fillDigitSums(uint8_t *array, const uint32_t size, const uint32_t radix) {
+    uint32_t i, high, digit;
+
+    for (digit = 0; digit < radix; digit++) {
+        array[digit] = digit;
+    }
+    for (i = radix, high = 1; i < size; high++) {
+        for (digit = 0; digit < radix; digit++) {
+            array[i++] = array[high] + digit;
         }
+    }
+}
+
+
+// next radix whose lookup array is to be populated by the build threads
+static _Atomic uint32_t digitSumNext;
 
-        // free the array
-        free(digitSumLookup);
-        digitSumLookup = NULL;
+
+// populate lookup arrays until every radix up to the given one has been taken
+static void *buildDigitSums(void *arg) {
+    const uint32_t maxRadix = *(const uint32_t *)arg;
+    uint32_t r;
+
+    while ((r = atomic_fetch_add(&digitSumNext, 1)) <= maxRadix) {
+        if (digitSumLookup[r]) {
+            fillDigitSums(digitSumLookup[r], digitSumDivider[r].divisor, r);
+        }
     }
+
+    return NULL;
 }
 
 
-// compute the digit sum of the given value in the given radix using groups of 4 digits
-// and return whether that digit sum is prime
-// Note: requires the digitSumLookup arrays to be allocated and populated
-//       and the smallprimes array to be allocated and populated
-// Note: returns true for any radix that is a power of 2 since these will have been checked
-//       before
-bool sumDigitsIsPrime(uint64_t number, uint32_t radix) {
-    // if the radix is a power of two then bail since it will have already been validated
-    if ((radix & (radix - 1)) == 0) return true;
+// return the size of the lookup array for the given radix that fits the given cache budget
+// and the number of digits it covers (at least 2)
+static uint32_t digitSumSize(const uint32_t radix, const uint64_t budget, uint32_t *digits) {
+    uint32_t arraySize = radix * radix;
 
-    // zero the sum
-    uint64_t sum = 0;
-    uint64_t dividor = 0;
+    *digits = 2;
+    while ((uint64_t)arraySize * radix <= budget) {
+        arraySize *= radix;
+        (*digits)++;
+    }
+    return arraySize;
+}
 
-    // get the lookup array for the given radix
-    uint8_t *lookup = digitSumLookup[radix];
 
-    // multiply the radix for 4 digits
-    radix *= radix;
-    radix *= radix;
+// huge page size the arenas are aligned to
+#define HUGE_PAGE_SIZE (2UL << 20)
 
-    // sum the digits (assume at least 12 digits for speed)
-    dividor = number / radix;
-    sum += lookup[number - (dividor * radix)];
-    number = dividor;
 
-    dividor = number / radix;
-    sum += lookup[number - (dividor * radix)];
-    number = dividor;
+// memory arena backed by huge pages where possible so lookups spread over megabytes of tables
+// need few TLB entries (disable with -DNO_HUGE_PAGES)
+typedef struct {
+    void *base;         // start of the arena
+    uint64_t length;    // mapped length (a whole number of huge pages)
+    bool hugetlb;       // whether the arena came from the reserved huge page pool
+} Arena;
 
-    dividor = number / radix;
-    sum += lookup[number - (dividor * radix)];
-    number = dividor;
 
-    // process any digits > 12
-    while (number) {
-        dividor = number / radix;
-        sum += lookup[number - (dividor * radix)];
-        number = dividor;
+// arena holding the digit sum lookup arrays
+static Arena digitSumArena;
+
+
+// allocate an arena of at least the given size aligned to a huge page
+// uses reserved huge pages (MAP_HUGETLB) if there are any, otherwise asks for transparent huge pages
+static void *allocArena(Arena *arena, const uint64_t size) {
+    uint64_t length = (size + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+    uint8_t *base = MAP_FAILED;
+
+    if (length == 0) {
+        length = HUGE_PAGE_SIZE;
     }
+    arena->hugetlb = false;
+#ifndef NO_HUGE_PAGES
+    base = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    arena->hugetlb = base != MAP_FAILED;
+#endif
 
-    // return whether the digit sum is prime
-    return smallprimes[sum];
+    // otherwise map extra so the arena can be trimmed to a huge page boundary
+    if (base == MAP_FAILED) {
+        uint8_t *mapped = mmap(NULL, length + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mapped == MAP_FAILED) {
+            fprintf(stderr, "Fatal: mmap failed for arena\n");
+            exit(EXIT_FAILURE);
+        }
+        base = (uint8_t *)(((uintptr_t)mapped + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1));
+        if (base > mapped) {
+            munmap(mapped, base - mapped);
+        }
+        munmap(base + length, mapped + HUGE_PAGE_SIZE - base);
+#ifndef NO_HUGE_PAGES
+        madvise(base, length, MADV_HUGEPAGE);
+#endif
+    }
+
+    arena->base = base;
+    arena->length = length;
+    return base;
 }
 
 
-// during the search
-void displayResult(const uint64_t value, const uint32_t radix) {
-    printf("%u: [%'lu] ", radix - 1, value);
-    for (uint32_t i = 2; i <= radix; i++) {
-        printf(" %lu", sumDigits(value, i));
+// map a file read only into an arena aligned to a huge page asking for transparent huge pages
+// (the kernel only backs a file mapping with them where the filesystem supports large folios)
+// returns NULL if the file cannot be mapped
+static void *mapArena(Arena *arena, const int32_t fd, const uint64_t size) {
+    uint8_t *reserved, *base;
+
+    // reserve extra address space so the mapping can start on a huge page boundary
+    reserved = mmap(NULL, size + HUGE_PAGE_SIZE, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (reserved == MAP_FAILED) {
+        return NULL;
     }
-    printf("\n");
-    fflush(stdout);
+    base = (uint8_t *)(((uintptr_t)reserved + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1));
+    if (mmap(base, size, PROT_READ, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED) {
+        munmap(reserved, size + HUGE_PAGE_SIZE);
+        return NULL;
+    }
+    if (base > reserved) {
+        munmap(reserved, base - reserved);
+    }
+    munmap(base + size, reserved + HUGE_PAGE_SIZE - base);
+#ifndef NO_HUGE_PAGES
+    madvise(base, size, MADV_HUGEPAGE);
+#endif
+
+    arena->base = base;
+    arena->length = size;
+    arena->hugetlb = false;
+    return base;
 }
 
 
-// check primes in the given range for consecutive number base digit sum primes
-// Note: requires "from" value to be in the form 30k+7
-//       works for radix values >= 32
-uint64_t checkRange32Plus(uint64_t from, const uint64_t to, const uint32_t radix) {
-    uint32_t digitsum = 0;
-    uint32_t r = 0;
-    uint32_t rodd = radix;
-    uint32_t reven = radix;
+// free an arena
+static void freeArena(Arena *arena) {
+    if (arena->base) {
+        munmap(arena->base, arena->length);
+        arena->base = NULL;
+    }
+}
+
+
+// display the page size backing an arena (read from the kernel's view of the mapping)
+static void displayArena(const Arena *arena, const char *name) {
+    uint64_t low = 0, high = 0, pageSize = 0, huge = 0, value;
+    char line[256];
+    FILE *smaps;
+    bool inside = false;
+
+    if ((smaps = fopen("/proc/self/smaps", "r"))) {
+        while (fgets(line, sizeof(line), smaps)) {
+            if (sscanf(line, "%lx-%lx ", &low, &high) == 2 && strchr(line, '-') < strchr(line, ' ')) {
+                inside = (uintptr_t)arena->base >= low && (uintptr_t)arena->base < high;
+            } else if (inside && sscanf(line, "KernelPageSize: %lu kB", &value) == 1) {
+                pageSize = value;
+            } else if (inside && (sscanf(line, "AnonHugePages: %lu kB", &value) == 1 ||
+                                  sscanf(line, "FilePmdMapped: %lu kB", &value) == 1)) {
+                huge += value;
+            }
+        }
+        fclose(smaps);
+    }
 
-    // there are less prime digit sums in even number bases than odd so search even first
-    if ((radix & 1) == 0) {
-        rodd--;
+    if (arena->hugetlb) {
+        printf("%s page size: %'lu KB (reserved huge pages)\n", name, pageSize);
+    } else if (huge) {
+        printf("%s page size: %'lu KB (transparent huge pages for %'lu of %'lu KB)\n", name, HUGE_PAGE_SIZE >> 10, huge, arena->length >> 10);
     } else {
-        reven--;
+        printf("%s page size: %'lu KB\n", name, pageSize ? pageSize : (uint64_t)sysconf(_SC_PAGESIZE) >> 10);
     }
+}
 
-    while (from <= to) {
-METRIC(checks)
-METRIC(plus32)
-        // do a quick check for base 2
-        if (smallprimes[_mm_popcnt_u64(from)]) {
-METRIC(gate2)
-            // do a quick check for base 4
-            digitsum = _mm_popcnt_u64(from & 0x5555555555555555UL);
-            digitsum += (_mm_popcnt_u64(from & 0xAAAAAAAAAAAAAAAAUL)) << 1;
-            if (smallprimes[digitsum]) {
-METRIC(gate4)
-                // do a quick check for base 8
-                digitsum = _mm_popcnt_u64(from & 0x9249249249249249UL);
-                digitsum += (_mm_popcnt_u64(from & 0x2492492492492492UL)) << 1;
-                digitsum += (_mm_popcnt_u64(from & 0x4924924924924924UL)) << 2;
-                if (smallprimes[digitsum]) {
-METRIC(gate8)
-                    // do a quick check for base 16
-                    digitsum = _mm_popcnt_u64(from & 0x1111111111111111UL);
-                    digitsum += (_mm_popcnt_u64(from & 0x2222222222222222UL)) << 1;
-                    digitsum += (_mm_popcnt_u64(from & 0x4444444444444444UL)) << 2;
-                    digitsum += (_mm_popcnt_u64(from & 0x8888888888888888UL)) << 3;
-                    if (smallprimes[digitsum]) {
-METRIC(gate16)
-                        // do a quick check for base 32
-                        digitsum = _mm_popcnt_u64(from & 0x1084210842108421UL);
-                        digitsum += (_mm_popcnt_u64(from & 0x2108421084210842UL)) << 1;
-                        digitsum += (_mm_popcnt_u64(from & 0x4210842108421084UL)) << 2;
-                        digitsum += (_mm_popcnt_u64(from & 0x8421084210842108UL)) << 3;
-                        digitsum += (_mm_popcnt_u64(from & 0x0842108421084210UL)) << 4;
-                        if (smallprimes[digitsum]) {
-METRIC(gate32)
-                            // check other bases starting at the largest since it will have fewest digits
-                            r = reven;
-                            while (r > 2 && sumDigitsIsPrime(from, r)) {
-                                r -= 2;
-                            }
-                            if (r == 2) { 
-                                r = rodd;
-                                while (r > 1 && sumDigitsIsPrime(from, r)) {
-                                    r -= 2;
-                                }
-                                if (r == 1) {
-METRIC(sums)
-                                    if (isPrime(from)) {
-METRIC(primes)
-                                        return from;
-                                    }
-                                }
-                            }
-                        }
-                    }
-                }
-            }
+
+// initialise the digit sum lookup arrays sizing each one to fit the given cache budget
+// each array covers as many digits as fit in the budget (at least 2) and there are none for
+// the power of 2 radices since the popcount gates check them
+// the arrays are populated by the given number of threads
+void initDigitSums(const uint32_t maxRadix, const uint64_t budget, const uint32_t threads) {
+    uint32_t i, r, digits, arraySize;
+    uint8_t *current = NULL;
+    uint64_t size = 0;
+    uint64_t started = monotonicNanos();
+    pthread_t handles[threads];
+
+    // allocate the array of lookup arrays
+    digitSumLookup = (uint8_t **)calloc(maxRadix  + 1, sizeof(uint8_t *));
+    if (!digitSumLookup) {
+        fprintf(stderr, "Fatal: malloc failed for array\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // size the arena holding every lookup array (each starting on a cache line)
+    for (r = 3; r <= maxRadix; r++) {
+        if ((r & (r - 1)) == 0) {
+            continue;
         }
+        size += (digitSumSize(r, budget, &digits) + 63) & ~63UL;
+    }
+    current = (uint8_t *)allocArena(&digitSumArena, size);
 
-        // go to next value
-        from += 4;
+    // for each radix
+    for (r = 3; r <= maxRadix; r++) {
+        if ((r & (r - 1)) == 0) {
+            continue;
+        }
 
-METRIC(checks)
-        // do a quick check for base 2
-        if (smallprimes[_mm_popcnt_u64(from)]) {
-METRIC(gate2)
-            // do a quick check for base 4
-            digitsum = _mm_popcnt_u64(from & 0x5555555555555555UL);
+        // choose the number of digits that fit the budget
+        arraySize = digitSumSize(r, budget, &digits);
+        digitSumDigits[r] = digits;
+        initDivider(&digitSumDivider[r], arraySize);
+
+        // place the lookup array in the arena
+        digitSumLookup[r] = current;
+        current += (arraySize + 63) & ~63UL;
+    }
+
+    // populate the arrays in parallel (the main thread acts as the first one)
+    atomic_store(&digitSumNext, 3);
+    for (i = 1; i < threads; i++) {
+        if (pthread_create(&handles[i], NULL, buildDigitSums, (void *)&maxRadix) != 0) {
+            fprintf(stderr, "Fatal: failed to create table build thread\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    buildDigitSums((void *)&maxRadix);
+    for (i = 1; i < threads; i++) {
+        pthread_join(handles[i], NULL);
+    }
+
+    // initialise packed digits for small radices
+    initPackedDigits(maxRadix);
+    digitSumBytes = size;
+
+    // display allocation size and the page size backing it
+    printf("Lookup cache for digit sums for radix 3 to %u = %'lu bytes (%'lu byte budget) built in %.2f ms\n",
+           maxRadix, size, budget, (double)(monotonicNanos() - started) / 1000000);
+    displayArena(&digitSumArena, "Lookup cache");
+}
+
+
+// return the cache budget for each digit sum lookup array
+// (a quarter of the L2 cache so the arrays for the radices checked most often stay in it)
+uint64_t digitSumBudget(void) {
+    long size = sysconf(_SC_LEVEL2_CACHE_SIZE);
+
+    if (size <= 0) {
+        size = 1L << 20;
+    }
+    return size / 4;
+}
+
+
+// digit sum table file identity and layout version (bump the version if the layout changes)
+#define TABLE_MAGIC 0x53454c4241545344UL
+#define TABLE_VERSION 1
+
+
+// lookup arrays start on a page boundary in the table file
+#define TABLE_ALIGN 4096UL
+
+
+// header at the start of the digit sum table file
+typedef struct {
+    uint64_t magic;         // TABLE_MAGIC
+    uint32_t version;       // TABLE_VERSION
+    uint32_t maxRadix;      // largest radix with a lookup array
+    uint64_t budget;        // cache budget the arrays were sized to
+    uint64_t size;          // size of the whole file
+    uint64_t offset[51];    // offset of the lookup array for each radix (0 if none)
+    uint32_t digits[51];    // digits covered by the lookup array for each radix
+} TableHeader;
+
+
+// mapping of the digit sum table file (base is NULL if the lookup arrays were allocated)
+static Arena tableArena;
+
+
+// write a digit sum table file for radices up to the given radix sized to the given cache budget
+// (written to a temporary file and renamed so processes starting together never see a partial one)
+void writeDigitSums(const char *path, const uint32_t maxRadix, const uint64_t budget) {
+    TableHeader header = { .magic = TABLE_MAGIC, .version = TABLE_VERSION, .maxRadix = maxRadix, .budget = budget };
+    char temp[PATH_MAX];
+    uint8_t *array = NULL;
+    uint32_t r, digits, arraySize;
+    uint64_t offset;
+    FILE *file;
+
+    // lay out the lookup arrays after the header
+    offset = (sizeof(header) + TABLE_ALIGN - 1) & ~(TABLE_ALIGN - 1);
+    for (r = 3; r <= maxRadix; r++) {
+        if ((r & (r - 1)) == 0) {
+            continue;
+        }
+        arraySize = digitSumSize(r, budget, &header.digits[r]);
+        header.offset[r] = offset;
+        offset = (offset + arraySize + TABLE_ALIGN - 1) & ~(TABLE_ALIGN - 1);
+    }
+    header.size = offset;
+
+    // create the temporary file
+    snprintf(temp, sizeof(temp), "%s.%d", path, (int32_t)getpid());
+    if (!(file = fopen(temp, "wb"))) {
+        fprintf(stderr, "Fatal: cannot create table file %s\n", temp);
+        exit(EXIT_FAILURE);
+    }
+
+    // write the header then populate and write each lookup array at its offset
+    bool written = fwrite(&header, sizeof(header), 1, file) == 1;
+    for (r = 3; r <= maxRadix && written; r++) {
+        if (header.offset[r] == 0) {
+            continue;
+        }
+        arraySize = digitSumSize(r, budget, &digits);
+        if (!(array = (uint8_t *)malloc(arraySize * sizeof(uint8_t)))) {
+            fprintf(stderr, "Fatal: malloc failed for table file array\n");
+            exit(EXIT_FAILURE);
+        }
+        fillDigitSums(array, arraySize, r);
+        written = fseek(file, header.offset[r], SEEK_SET) == 0 && fwrite(array, arraySize, 1, file) == 1;
+        free(array);
+    }
+
+    // pad to the full size and publish the file
+    written = written && fseek(file, header.size - 1, SEEK_SET) == 0 && fputc(0, file) != EOF;
+    if (fclose(file) != 0 || !written || rename(temp, path) != 0) {
+        remove(temp);
+        fprintf(stderr, "Fatal: cannot write table file %s\n", path);
+        exit(EXIT_FAILURE);
+    }
+}
+
+
+// map the digit sum lookup arrays read only from the given table file
+// returns false if the file is missing, is a different version, was sized to a different cache budget,
+// does not cover the given radix or has a lookup array that does not fit in it
+bool mapDigitSums(const char *path, const uint32_t maxRadix, const uint64_t budget) {
+    const TableHeader *header;
+    struct stat status;
+    uint64_t arraySize;
+    uint32_t r, i;
+    void *map;
+    int32_t fd;
+
+    // open the file
+    if ((fd = open(path, O_RDONLY)) < 0) {
+        return false;
+    }
+    if (fstat(fd, &status) != 0 || (uint64_t)status.st_size < sizeof(TableHeader)) {
+        close(fd);
+        return false;
+    }
+
+    // map the file (the mapping stays valid after the descriptor is closed)
+    map = mapArena(&tableArena, fd, status.st_size);
+    close(fd);
+    if (!map) {
+        return false;
+    }
+
+    // validate the header
+    header = (const TableHeader *)map;
+    if (header->magic != TABLE_MAGIC || header->version != TABLE_VERSION || header->maxRadix < maxRadix ||
+        header->maxRadix > 50 || header->budget != budget || header->size != (uint64_t)status.st_size) {
+        freeArena(&tableArena);
+        return false;
+    }
+
+    // validate the lookup array of each radix that is not a power of 2 lies within the file
+    for (r = 3; r <= maxRadix; r++) {
+        if ((r & (r - 1)) == 0) {
+            continue;
+        }
+        arraySize = 1;
+        for (i = 0; i < header->digits[r] && arraySize <= header->size; i++) {
+            arraySize *= r;
+        }
+        if (header->digits[r] < 2 || header->offset[r] < sizeof(TableHeader) || header->offset[r] > header->size ||
+            arraySize > header->size - header->offset[r]) {
+            freeArena(&tableArena);
+            return false;
+        }
+    }
+
+    // point the lookup arrays into the mapping
+    if (!(digitSumLookup = (uint8_t **)calloc(maxRadix + 1, sizeof(uint8_t *)))) {
+        fprintf(stderr, "Fatal: malloc failed for array\n");
+        exit(EXIT_FAILURE);
+    }
+    for (r = 3; r <= maxRadix; r++) {
+        if ((r & (r - 1)) == 0) {
+            continue;
+        }
+        arraySize = 1;
+        for (i = 0; i < header->digits[r]; i++) {
+            arraySize *= r;
+        }
+        digitSumDigits[r] = header->digits[r];
+        digitSumLookup[r] = (uint8_t *)map + header->offset[r];
+        initDivider(&digitSumDivider[r], arraySize);
+    }
+    digitSumBytes = status.st_size;
+
+    return true;
+}
+
+
+// initialise the digit sum lookup arrays from the given table file building the file first
+// if it is missing or unusable (including one sized to a different cache budget)
+void loadDigitSums(const char *path, const uint32_t maxRadix, const uint64_t budget) {
+    bool built = false;
+
+    // build the file if it cannot be mapped
+    if (!mapDigitSums(path, maxRadix, budget)) {
+        writeDigitSums(path, maxRadix, budget);
+        built = true;
+        if (!mapDigitSums(path, maxRadix, budget)) {
+            fprintf(stderr, "Fatal: cannot map table file %s\n", path);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    // initialise packed digits for small radices
+    initPackedDigits(maxRadix);
+
+    // display mapping size
+    printf("Lookup cache for digit sums for radix 3 to %u = %'lu bytes mapped from %s (%s, %'lu byte budget)\n",
+           maxRadix, tableArena.length, path, built ? "built" : "shared", ((const TableHeader *)tableArena.base)->budget);
+    displayArena(&tableArena, "Lookup cache");
+}
+
+
+// free the digit sum lookup arrays
+void freeDigitSums() {
+    // unmap the table file or free the arena holding the arrays
+    freeArena(&tableArena);
+    freeArena(&digitSumArena);
+
+    // free the array
+    free(digitSumLookup);
+    digitSumLookup = NULL;
+
+    // free packed digits for small radices
+    freePackedDigits();
+}
+
+
+// compute the digit sum of the given value in the given radix using groups of digits
+// and return whether that digit sum is prime
+// Note: requires the digitSumLookup arrays to be allocated and populated
+//       and the smallprimes array to be allocated and populated
+// Note: returns true for any radix that is a power of 2 since these will have been checked
+//       before
+bool sumDigitsIsPrime(uint64_t number, uint32_t radix) {
+    // if the radix is a power of two then bail since it will have already been validated
+    if ((radix & (radix - 1)) == 0) return true;
+
+    // zero the sum
+    uint64_t sum = 0;
+    uint64_t dividor = 0;
+
+    // get the lookup array and reciprocal for a group of digits of the given radix
+    const uint8_t *lookup = digitSumLookup[radix];
+    const Divider *divider = &digitSumDivider[radix];
+    const uint64_t group = divider->divisor;
+
+    // sum the digits (assume at least 3 groups of digits for speed)
+    dividor = divide(number, divider);
+    sum += lookup[number - (dividor * group)];
+    number = dividor;
+
+    dividor = divide(number, divider);
+    sum += lookup[number - (dividor * group)];
+    number = dividor;
+
+    dividor = divide(number, divider);
+    sum += lookup[number - (dividor * group)];
+    number = dividor;
+
+    // process any remaining groups
+    while (number) {
+        dividor = divide(number, divider);
+        sum += lookup[number - (dividor * group)];
+        number = dividor;
+    }
+
+    // return whether the digit sum is prime
+    return smallprimes[sum];
+}
+
+
+// digit sum of the digits above the lowest group for a radix, kept while the search moves through
+// a run of values that share them so only the lowest group of digits needs to be looked up
+// (radices with packed digits also keep the packed digits of the last value checked and add the
+// difference to them)
+typedef struct {
+    uint64_t base;      // first value of the run (the digits above the lowest group followed by zeroes)
+    uint64_t size;      // number of values in the run (radix^digits, 0 until the cache is first filled)
+    uint32_t highSum;   // digit sum of the digits above the lowest group
+    uint64_t value;     // last value checked (0 until the first check)
+    bool packed;        // whether the packed digits are for the last value checked
+    uint64_t low;       // packed low digits of the last value
+    uint64_t high;      // packed high digits of the last value
+} DigitSumCache;
+
+
+// compute whether the digit sum of the given value is prime for a radix with packed digits
+// by adding the difference from the last value checked to its packed digits
+static inline bool packedDigitSumIsPrime(const uint64_t number, const PackedRadix *packed, DigitSumCache *cache) {
+    uint64_t delta = number - cache->value;
+    uint64_t high = 0;
+
+    if (cache->packed && number >= cache->value && delta < packed->word.divisor) {
+        // add the difference carrying into the high digits
+        if (addPackedDigits(&cache->low, packDigits(delta, packed), packed)) {
+            addPackedDigits(&cache->high, 1, packed);
+        }
+    } else {
+        // pack all the digits
+        high = divide(number, &packed->word);
+        cache->low = packDigits(number - (high * packed->word.divisor), packed);
+        cache->high = packDigits(high, packed);
+        cache->packed = true;
+    }
+    cache->value = number;
+
+    // return whether the digit sum is prime
+    return smallprimes[sumPackedDigits(cache->low, packed) + sumPackedDigits(cache->high, packed)];
+}
+
+
+// compute whether the digit sum of the given value in the given radix is prime using the cache
+// for the digits above the lowest group which is only recomputed when those digits change
+// Note: requires the same arrays as sumDigitsIsPrime
+//       returns true for any radix that is a power of 2 since these will have been checked
+//       before
+static inline bool sumDigitsIsPrimeCached(const uint64_t number, const uint32_t radix, DigitSumCache *cache) {
+    // if the radix is a power of two then bail since it will have already been validated
+    if ((radix & (radix - 1)) == 0) return true;
+
+    // use the packed digits for radix 3 (which has the most digits) and for the others when
+    // stepping from one candidate to a nearby one
+    if (radix <= PACKED_MAX_RADIX) {
+        if (radix == 3 || (cache->value && number >= cache->value && number - cache->value <= PACKED_MAX_STEP)) {
+            return packedDigitSumIsPrime(number, &packedRadix[radix], cache);
+        }
+        cache->packed = false;
+        cache->value = number;
+    }
+
+    // get the lookup array for the given radix
+    const uint8_t *lookup = digitSumLookup[radix];
+
+    // check if the digits above the lowest group have changed (or the cache is empty)
+    if (number - cache->base >= cache->size) {
+        const Divider *divider = &digitSumDivider[radix];
+        const uint64_t group = divider->divisor;
+        uint64_t high = divide(number, divider);
+        uint64_t dividor = 0;
+
+        // start of the run
+        cache->base = high * group;
+        cache->size = group;
+
+        // sum the digits above the lowest group
+        cache->highSum = 0;
+        while (high) {
+            dividor = divide(high, divider);
+            cache->highSum += lookup[high - (dividor * group)];
+            high = dividor;
+        }
+    }
+
+    // return whether the digit sum is prime
+    return smallprimes[cache->highSum + lookup[number - cache->base]];
+}
+
+
+// smallest value displayed for each radix (0 if none) for the report
+static uint64_t resultValues[51];
+
+
+// during the search
+void displayResult(const uint64_t value, const uint32_t radix) {
+    resultValues[radix] = value;
+    printf("%u: [%'lu] ", radix - 1, value);
+    for (uint32_t i = 2; i <= radix; i++) {
+        printf(" %lu", sumDigits(value, i));
+    }
+    printf("\n");
+    fflush(stdout);
+}
+
+
+// largest number of candidates in a turn of the wheel (mod 2310)
+#define WHEEL_MAX_COUNT 480
+
+
+// wheel of candidates coprime to the small primes
+// each turn of the wheel starts at a value in the form (modulus * k) + first
+typedef struct {
+    uint32_t modulus;                       // product of the wheel primes
+    uint32_t first;                         // smallest prime that is not a wheel prime
+    uint32_t count;                         // candidates per turn
+    uint64_t offsets[WHEEL_MAX_COUNT];      // offset of each candidate from the start of the turn
+    uint32_t steps[WHEEL_MAX_COUNT];        // step from each candidate to the next
+    uint64_t residues[(2310 + 127) / 64];   // bitmap of the residues mod the modulus that are candidates
+                                            // (repeated for 64 bits past the modulus so any 64 can be read)
+    Divider divider;                        // reciprocal of the modulus
+} Wheel;
+
+
+// wheel used by the search kernels
+static Wheel wheel;
+
+
+// build the wheel for the given maximum radix
+// the digit sum in radix r is congruent to the value mod (r - 1) so any value that shares a
+// factor p with (r - 1) has a digit sum that is a multiple of p, which rejects it in radix r
+// unless the sum is p itself, so 7 is added to the wheel once radix 8 is searched and 11 once
+// radix 12 is searched letting the wheel drop those values before any digit sum is computed
+// the wheel is limited to the given largest modulus
+void initWheel(const uint32_t maxRadix, const uint32_t largest) {
+    uint32_t offset = 0;
+    uint32_t value = 0;
+
+    // choose the wheel primes (clearing any previous wheel)
+    memset(wheel.residues, 0, sizeof(wheel.residues));
+    wheel.modulus = 30;
+    wheel.first = 7;
+    if (maxRadix >= 8 && largest >= 210) {
+        wheel.modulus *= 7;
+        wheel.first = 11;
+    }
+    if (maxRadix >= 12 && largest >= 2310) {
+        wheel.modulus *= 11;
+        wheel.first = 13;
+    }
+
+    // find the candidates in a turn coprime to the modulus
+    wheel.count = 0;
+    for (offset = 0; offset < wheel.modulus; offset++) {
+        value = wheel.first + offset;
+        if (value % 2 && value % 3 && value % 5 && (wheel.first < 11 || value % 7) && (wheel.first < 13 || value % 11)) {
+            wheel.offsets[wheel.count++] = offset;
+            wheel.residues[(value % wheel.modulus) >> 6] |= 1UL << ((value % wheel.modulus) & 63);
+        }
+    }
+    for (offset = wheel.modulus; offset < wheel.modulus + 64; offset++) {
+        value = offset % wheel.modulus;
+        wheel.residues[offset >> 6] |= ((wheel.residues[value >> 6] >> (value & 63)) & 1) << (offset & 63);
+    }
+    initDivider(&wheel.divider, wheel.modulus);
+
+    // work out the steps between them wrapping around to the next turn
+    for (offset = 0; offset < wheel.count; offset++) {
+        if (offset + 1 < wheel.count) {
+            wheel.steps[offset] = wheel.offsets[offset + 1] - wheel.offsets[offset];
+        } else {
+            wheel.steps[offset] = wheel.modulus - wheel.offsets[offset];
+        }
+    }
+
+    printf("Wheel mod %u with %u candidates per turn\n", wheel.modulus, wheel.count);
+}
+
+
+// return the start of the wheel turn containing the given value
+// Note: values below the first candidate return the first turn
+static inline uint64_t wheelAlign(const uint64_t value) {
+    if (value < wheel.first) {
+        return wheel.first;
+    }
+    return (wheel.modulus * ((value - wheel.first) / wheel.modulus)) + wheel.first;
+}
+
+
+// return whether the given value is a candidate on the wheel
+static inline bool wheelCandidate(const uint64_t value) {
+    uint64_t residue = value - (divide(value, &wheel.divider) * wheel.modulus);
+
+    return (wheel.residues[residue >> 6] >> (residue & 63)) & 1;
+}
+
+
+// return the wheel candidate bits for the 64 values starting at a value with the given residue
+static inline uint64_t wheelBits(const uint32_t residue) {
+    const uint64_t low = wheel.residues[residue >> 6] >> (residue & 63);
+
+    return (residue & 63) ? low | (wheel.residues[(residue >> 6) + 1] << (64 - (residue & 63))) : low;
+}
+
+
+// return the first candidate on the wheel at or after the given value and its position in the turn
+static inline uint64_t wheelStart(const uint64_t value, uint32_t *position) {
+    uint64_t turn = wheelAlign(value);
+
+    for (uint32_t i = 0; i < wheel.count; i++) {
+        if (turn + wheel.offsets[i] >= value) {
+            *position = i;
+            return turn + wheel.offsets[i];
+        }
+    }
+
+    *position = 0;
+    return turn + wheel.modulus;
+}
+
+
+// number of radix checks needed before the adaptive order replaces the default one
+#define RADIX_MIN_CHECKS (1UL << 16)
+
+
+// radix check statistics for a search thread (added to the totals after each chunk)
+typedef struct {
+    uint64_t checks[51];    // number of checks by radix
+    uint64_t rejects[51];   // number of checks that found a composite digit sum by radix
+} RadixStats;
+
+
+// statistics for the current thread
+static _Thread_local RadixStats threadRadixStats;
+
+
+// adaptive radix order shared by the search threads
+// radices are ranked by the chance they reject a candidate divided by the cost of checking them
+static struct {
+    pthread_mutex_t lock;
+    _Atomic uint64_t checks[51];    // total checks by radix
+    _Atomic uint64_t rejects[51];   // total rejections by radix
+    double cost[51];                // nanoseconds per check by radix
+    uint32_t ranking[51];           // all the radices checked by digit sum best first
+    uint32_t count;                 // number of radices in the ranking (0 until there are enough checks)
+} radixOrder = { .lock = PTHREAD_MUTEX_INITIALIZER };
+
+
+// build the default order the radices not covered by the power of 2 gates are checked in
+// returning the number of radices
+static uint32_t defaultRadixOrder(const uint32_t radix, uint32_t *order) {
+    uint32_t count = 0;
+    uint32_t r = 0;
+
+    // there are less prime digit sums in even number bases than odd so check even first
+    if (radix >= 32) {
+        for (r = (radix & 1) ? radix - 1 : radix; r > 2; r -= 2) {
+            if ((r & (r - 1)) != 0) {
+                order[count++] = r;
+            }
+        }
+        for (r = (radix & 1) ? radix : radix - 1; r > 1; r -= 2) {
+            order[count++] = r;
+        }
+        return count;
+    }
+
+    // check other bases starting at the largest since it will have fewest digits
+    for (r = radix; r > 2; r--) {
+        if ((r & (r - 1)) != 0) {
+            order[count++] = r;
+        }
+    }
+    return count;
+}
+
+
+// get the order to check the radices up to the given radix in returning the number of radices
+// (the adaptive order once there are enough statistics, otherwise the default order)
+static uint32_t loadRadixOrder(const uint32_t radix, uint32_t *order) {
+    uint32_t count = 0;
+
+    pthread_mutex_lock(&radixOrder.lock);
+    for (uint32_t i = 0; i < radixOrder.count; i++) {
+        if (radixOrder.ranking[i] <= radix) {
+            order[count++] = radixOrder.ranking[i];
+        }
+    }
+    pthread_mutex_unlock(&radixOrder.lock);
+
+    if (count == 0) {
+        count = defaultRadixOrder(radix, order);
+    }
+    return count;
+}
+
+
+// check the digit sums of a candidate for the radices in the given order counting the checks
+// and rejections for the adaptive order
+static inline bool checkOrder(const uint64_t number, const uint32_t *order, const uint32_t count, DigitSumCache *cache) {
+    for (uint32_t i = 0; i < count; i++) {
+        threadRadixStats.checks[order[i]]++;
+        if (!sumDigitsIsPrimeCached(number, order[i], &cache[order[i]])) {
+            threadRadixStats.rejects[order[i]]++;
+            return false;
+        }
+    }
+    return true;
+}
+
+
+// measure the cost of checking each radix up to the given radix near the given value
+void measureRadixCosts(const uint64_t from, const uint32_t maxRadix) {
+    DigitSumCache cache[51] = {{0}};
+    uint64_t start = 0;
+    uint32_t passed = 0;
+
+    for (uint32_t r = 3; r <= maxRadix; r++) {
+        start = monotonicNanos();
+        for (uint64_t i = 0; i < 4096; i++) {
+            passed += sumDigitsIsPrimeCached(from + 30 * i + 1, r, &cache[r]);
+        }
+        radixOrder.cost[r] = (double)(monotonicNanos() - start + 1) / 4096;
+    }
+
+    // keep the checks from being optimized away
+    if (passed == UINT32_MAX) {
+        printf("\n");
+    }
+}
+
+
+// add the statistics for the current thread to the totals and rerank the radices
+void updateRadixOrder(const uint32_t maxRadix) {
+    RadixStats *stats = &threadRadixStats;
+    double score[51];
+    uint64_t total = 0;
+    uint64_t checks = 0;
+    uint32_t count = 0;
+    uint32_t r = 0;
+    uint32_t i = 0;
+
+    for (r = 3; r <= maxRadix; r++) {
+        if (stats->checks[r]) {
+            atomic_fetch_add(&radixOrder.checks[r], stats->checks[r]);
+            atomic_fetch_add(&radixOrder.rejects[r], stats->rejects[r]);
+            stats->checks[r] = 0;
+            stats->rejects[r] = 0;
+        }
+        total += atomic_load(&radixOrder.checks[r]);
+    }
+    if (total < RADIX_MIN_CHECKS) {
+        return;
+    }
+
+    // rank the radices by rejection rate (smoothed for rarely reached radices) divided by cost
+    pthread_mutex_lock(&radixOrder.lock);
+    for (r = 3; r <= maxRadix; r++) {
+        if ((r & (r - 1)) == 0) {
+            continue;
+        }
+        checks = atomic_load(&radixOrder.checks[r]);
+        score[r] = ((double)atomic_load(&radixOrder.rejects[r]) + 1) / (checks + 2) / radixOrder.cost[r];
+
+        // insert in order of score
+        for (i = count; i > 0 && score[radixOrder.ranking[i - 1]] < score[r]; i--) {
+            radixOrder.ranking[i] = radixOrder.ranking[i - 1];
+        }
+        radixOrder.ranking[i] = r;
+        count++;
+    }
+    radixOrder.count = count;
+    pthread_mutex_unlock(&radixOrder.lock);
+}
+
+
+// display the radix order used for the given radix
+void displayRadixOrder(const uint32_t radix) {
+    uint32_t order[51];
+    uint32_t count = loadRadixOrder(radix, order);
+
+    printf("Radix order:");
+    for (uint32_t i = 0; i < count; i++) {
+        printf(" %u", order[i]);
+    }
+    printf("\n");
+}
+
+
+// metrics totals for the search and the radix statistics when the search started
+static struct {
+    pthread_mutex_t lock;
+    Metrics total;
+    uint64_t checks[51];
+    uint64_t rejects[51];
+} metricTotals = { .lock = PTHREAD_MUTEX_INITIALIZER };
+
+
+// add the metrics for the current thread to the totals
+void updateMetrics(void) {
+    uint64_t *from = (uint64_t *)threadMetrics.funnel;
+    uint64_t *to = (uint64_t *)metricTotals.total.funnel;
+
+    pthread_mutex_lock(&metricTotals.lock);
+    for (uint32_t i = 0; i < FUNNELS * sizeof(Funnel) / sizeof(uint64_t); i++) {
+        to[i] += from[i];
+        from[i] = 0;
+    }
+    pthread_mutex_unlock(&metricTotals.lock);
+}
+
+
+// start counting metrics for a search noting the radix statistics so far
+// (so checks made before the search, calibrating the kernels, are left out of the histogram)
+void startMetrics(const uint32_t maxRadix) {
+    updateRadixOrder(maxRadix);
+    memset(&threadMetrics, 0, sizeof(threadMetrics));
+    for (uint32_t r = 0; r <= 50; r++) {
+        metricTotals.checks[r] = atomic_load(&radixOrder.checks[r]);
+        metricTotals.rejects[r] = atomic_load(&radixOrder.rejects[r]);
+    }
+}
+
+
+// display one step of a funnel with the percentage of the previous step that reached it
+static uint64_t displayFunnelStep(const char *name, const uint64_t count, const uint64_t previous) {
+    if (count == 0) {
+        return previous;
+    }
+    if (previous) {
+        printf(" %s %'lu (%.1f%%)", name, count, 100.0 * count / previous);
+    } else {
+        printf(" %s %'lu", name, count);
+    }
+    return count;
+}
+
+
+// display the search funnel for each kernel and the rejections by radix
+// (the low bit kernels check radix 2, 4, 16 and 32 before the wheel and radix 8)
+void displayMetrics(const uint32_t maxRadix) {
+    const char *scalarNames[] = { "radix 3-15", "radix 16-31", "radix 32+" };
+    const char *kernelNames[] = { "vector", "batch", "lowbit", "sieve" };
+    const char *gateNames[FUNNEL_GATES] = { "radix 3", "radix 4-7", "radix 8-15", "radix 16-31", "radix 32+" };
+    Funnel *funnel = NULL;
+    uint64_t previous = 0;
+    uint64_t checks = 0;
+    uint64_t rejects = 0;
+
+    for (uint32_t i = 0; i < FUNNELS; i++) {
+        funnel = &metricTotals.total.funnel[i];
+        if (funnel->checks == 0) {
+            continue;
+        }
+        if (i < FUNNEL_VECTOR) {
+            printf("Funnel scalar %s:", scalarNames[i]);
+        } else {
+            printf("Funnel %s %s:", kernelNames[(i - FUNNEL_VECTOR) / FUNNEL_GATES], gateNames[(i - FUNNEL_VECTOR) % FUNNEL_GATES]);
+        }
+        printf(" checks %'lu", funnel->checks);
+        previous = funnel->checks;
+        previous = displayFunnelStep("base2", funnel->gate2, previous);
+        previous = displayFunnelStep("base4", funnel->gate4, previous);
+        if (funnel->wheel == 0) {
+            previous = displayFunnelStep("base8", funnel->gate8, previous);
+        }
+        previous = displayFunnelStep("base16", funnel->gate16, previous);
+        previous = displayFunnelStep("base32", funnel->gate32, previous);
+        if (funnel->wheel) {
+            previous = displayFunnelStep("wheel", funnel->wheel, previous);
+            previous = displayFunnelStep("base8", funnel->gate8, previous);
+        }
+        previous = displayFunnelStep("quick", funnel->quick, previous);
+        previous = displayFunnelStep("sums", funnel->sums, previous);
+        displayFunnelStep("primes", funnel->primes, previous);
+        printf("\n");
+    }
+
+    // rejections by each radix checked after the power of 2 gates
+    printf("Rejections by radix:\n");
+    for (uint32_t r = 3; r <= maxRadix; r++) {
+        checks = atomic_load(&radixOrder.checks[r]) - metricTotals.checks[r];
+        rejects = atomic_load(&radixOrder.rejects[r]) - metricTotals.rejects[r];
+        if (checks) {
+            printf("%2u: %'lu checked %'lu rejected (%.1f%%)\n", r, checks, rejects, 100.0 * rejects / checks);
+        }
+    }
+}
+
+
+// check primes in the given range for consecutive number base digit sum primes
+//       works for radix values >= 32
+static inline __attribute__((always_inline)) uint64_t checkRange32PlusBody(uint64_t from, const uint64_t to, const uint32_t radix, const bool metrics) {
+    Funnel *funnel = &threadMetrics.funnel[FUNNEL_32PLUS];
+    DigitSumCache cache[51] = {{0}};
+    const uint32_t *steps = wheel.steps;
+    const uint32_t turn = wheel.count;
+    const uint64_t low = from;
+    uint32_t step = 0;
+    uint32_t digitsum = 0;
+    uint32_t order[51];
+    const uint32_t radices = loadRadixOrder(radix, order);
+
+    // start at the first candidate on the wheel backing up to the start of a group of 8 steps
+    // since the loop is unrolled for 8 steps (values before low are checked but not returned)
+    from = wheelStart(from, &step);
+    while (step & 7) {
+        step--;
+        from -= steps[step];
+    }
+
+    while (from <= to) {
+        // steps for this group of 8 candidates
+        const uint32_t step0 = steps[step];
+        const uint32_t step1 = steps[step + 1];
+        const uint32_t step2 = steps[step + 2];
+        const uint32_t step3 = steps[step + 3];
+        const uint32_t step4 = steps[step + 4];
+        const uint32_t step5 = steps[step + 5];
+        const uint32_t step6 = steps[step + 6];
+        const uint32_t step7 = steps[step + 7];
+
+METRIC(checks)
+        // do a quick check for base 2
+        if (smallprimes[_mm_popcnt_u64(from)]) {
+METRIC(gate2)
+            // do a quick check for base 4
+            digitsum = _mm_popcnt_u64(from & 0x5555555555555555UL);
+            digitsum += (_mm_popcnt_u64(from & 0xAAAAAAAAAAAAAAAAUL)) << 1;
+            if (smallprimes[digitsum]) {
+METRIC(gate4)
+                // do a quick check for base 8
+                digitsum = _mm_popcnt_u64(from & 0x9249249249249249UL);
+                digitsum += (_mm_popcnt_u64(from & 0x2492492492492492UL)) << 1;
+                digitsum += (_mm_popcnt_u64(from & 0x4924924924924924UL)) << 2;
+                if (smallprimes[digitsum]) {
+METRIC(gate8)
+                    // do a quick check for base 16
+                    digitsum = _mm_popcnt_u64(from & 0x1111111111111111UL);
+                    digitsum += (_mm_popcnt_u64(from & 0x2222222222222222UL)) << 1;
+                    digitsum += (_mm_popcnt_u64(from & 0x4444444444444444UL)) << 2;
+                    digitsum += (_mm_popcnt_u64(from & 0x8888888888888888UL)) << 3;
+                    if (smallprimes[digitsum]) {
+METRIC(gate16)
+                        // do a quick check for base 32
+                        digitsum = _mm_popcnt_u64(from & 0x1084210842108421UL);
+                        digitsum += (_mm_popcnt_u64(from & 0x2108421084210842UL)) << 1;
+                        digitsum += (_mm_popcnt_u64(from & 0x4210842108421084UL)) << 2;
+                        digitsum += (_mm_popcnt_u64(from & 0x8421084210842108UL)) << 3;
+                        digitsum += (_mm_popcnt_u64(from & 0x0842108421084210UL)) << 4;
+                        if (smallprimes[digitsum]) {
+METRIC(gate32)
+METRIC(quick)
+                            // check other bases in the adaptive order
+                            if (checkOrder(from, order, radices, cache)) {
+METRIC(sums)
+                                if (from >= low && from <= to && isPrime(from)) {
+METRIC(primes)
+                                    return from;
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        // go to next value on the wheel
+        from += step0;
+
+METRIC(checks)
+        // do a quick check for base 2
+        if (smallprimes[_mm_popcnt_u64(from)]) {
+METRIC(gate2)
+            // do a quick check for base 4
+            digitsum = _mm_popcnt_u64(from & 0x5555555555555555UL);
+            digitsum += (_mm_popcnt_u64(from & 0xAAAAAAAAAAAAAAAAUL)) << 1;
+            if (smallprimes[digitsum]) {
+METRIC(gate4)
+                // do a quick check for base 8
+                digitsum = _mm_popcnt_u64(from & 0x9249249249249249UL);
+                digitsum += (_mm_popcnt_u64(from & 0x2492492492492492UL)) << 1;
+                digitsum += (_mm_popcnt_u64(from & 0x4924924924924924UL)) << 2;
+                if (smallprimes[digitsum]) {
+METRIC(gate8)
+                    // do a quick check for base 16
+                    digitsum = _mm_popcnt_u64(from & 0x1111111111111111UL);
+                    digitsum += (_mm_popcnt_u64(from & 0x2222222222222222UL)) << 1;
+                    digitsum += (_mm_popcnt_u64(from & 0x4444444444444444UL)) << 2;
+                    digitsum += (_mm_popcnt_u64(from & 0x8888888888888888UL)) << 3;
+                    if (smallprimes[digitsum]) {
+METRIC(gate16)
+                        // do a quick check for base 32
+                        digitsum = _mm_popcnt_u64(from & 0x1084210842108421UL);
+                        digitsum += (_mm_popcnt_u64(from & 0x2108421084210842UL)) << 1;
+                        digitsum += (_mm_popcnt_u64(from & 0x4210842108421084UL)) << 2;
+                        digitsum += (_mm_popcnt_u64(from & 0x8421084210842108UL)) << 3;
+                        digitsum += (_mm_popcnt_u64(from & 0x0842108421084210UL)) << 4;
+                        if (smallprimes[digitsum]) {
+METRIC(gate32)
+METRIC(quick)
+                            // check other bases in the adaptive order
+                            if (checkOrder(from, order, radices, cache)) {
+METRIC(sums)
+                                if (from >= low && from <= to && isPrime(from)) {
+METRIC(primes)
+                                    return from;
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        // go to next value on the wheel
+        from += step1;
+
+METRIC(checks)
+        // do a quick check for base 2
+        if (smallprimes[_mm_popcnt_u64(from)]) {
+METRIC(gate2)
+            // do a quick check for base 4
+            digitsum = _mm_popcnt_u64(from & 0x5555555555555555UL);
+            digitsum += (_mm_popcnt_u64(from & 0xAAAAAAAAAAAAAAAAUL)) << 1;
+            if (smallprimes[digitsum]) {
+METRIC(gate4)
+                // do a quick check for base 8
+                digitsum = _mm_popcnt_u64(from & 0x9249249249249249UL);
+                digitsum += (_mm_popcnt_u64(from & 0x2492492492492492UL)) << 1;
+                digitsum += (_mm_popcnt_u64(from & 0x4924924924924924UL)) << 2;
+                if (smallprimes[digitsum]) {
+METRIC(gate8)
+                    // do a quick check for base 16
+                    digitsum = _mm_popcnt_u64(from & 0x1111111111111111UL);
+                    digitsum += (_mm_popcnt_u64(from & 0x2222222222222222UL)) << 1;
+                    digitsum += (_mm_popcnt_u64(from & 0x4444444444444444UL)) << 2;
+                    digitsum += (_mm_popcnt_u64(from & 0x8888888888888888UL)) << 3;
+                    if (smallprimes[digitsum]) {
+METRIC(gate16)
+                        // do a quick check for base 32
+                        digitsum = _mm_popcnt_u64(from & 0x1084210842108421UL);
+                        digitsum += (_mm_popcnt_u64(from & 0x2108421084210842UL)) << 1;
+                        digitsum += (_mm_popcnt_u64(from & 0x4210842108421084UL)) << 2;
+                        digitsum += (_mm_popcnt_u64(from & 0x8421084210842108UL)) << 3;
+                        digitsum += (_mm_popcnt_u64(from & 0x0842108421084210UL)) << 4;
+                        if (smallprimes[digitsum]) {
+METRIC(gate32)
+METRIC(quick)
+                            // check other bases in the adaptive order
+                            if (checkOrder(from, order, radices, cache)) {
+METRIC(sums)
+                                if (from >= low && from <= to && isPrime(from)) {
+METRIC(primes)
+                                    return from;
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        // go to next value on the wheel
+        from += step2;
+
+METRIC(checks)
+        // do a quick check for base 2
+        if (smallprimes[_mm_popcnt_u64(from)]) {
+METRIC(gate2)
+            // do a quick check for base 4
+            digitsum = _mm_popcnt_u64(from & 0x5555555555555555UL);
+            digitsum += (_mm_popcnt_u64(from & 0xAAAAAAAAAAAAAAAAUL)) << 1;
+            if (smallprimes[digitsum]) {
+METRIC(gate4)
+                // do a quick check for base 8
+                digitsum = _mm_popcnt_u64(from & 0x9249249249249249UL);
+                digitsum += (_mm_popcnt_u64(from & 0x2492492492492492UL)) << 1;
+                digitsum += (_mm_popcnt_u64(from & 0x4924924924924924UL)) << 2;
+                if (smallprimes[digitsum]) {
+METRIC(gate8)
+                    // do a quick check for base 16
+                    digitsum = _mm_popcnt_u64(from & 0x1111111111111111UL);
+                    digitsum += (_mm_popcnt_u64(from & 0x2222222222222222UL)) << 1;
+                    digitsum += (_mm_popcnt_u64(from & 0x4444444444444444UL)) << 2;
+                    digitsum += (_mm_popcnt_u64(from & 0x8888888888888888UL)) << 3;
+                    if (smallprimes[digitsum]) {
+METRIC(gate16)
+                        // do a quick check for base 32
+                        digitsum = _mm_popcnt_u64(from & 0x1084210842108421UL);
+                        digitsum += (_mm_popcnt_u64(from & 0x2108421084210842UL)) << 1;
+                        digitsum += (_mm_popcnt_u64(from & 0x4210842108421084UL)) << 2;
+                        digitsum += (_mm_popcnt_u64(from & 0x8421084210842108UL)) << 3;
+                        digitsum += (_mm_popcnt_u64(from & 0x0842108421084210UL)) << 4;
+                        if (smallprimes[digitsum]) {
+METRIC(gate32)
+METRIC(quick)
+                            // check other bases in the adaptive order
+                            if (checkOrder(from, order, radices, cache)) {
+METRIC(sums)
+                                if (from >= low && from <= to && isPrime(from)) {
+METRIC(primes)
+                                    return from;
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        // go to next value on the wheel
+        from += step3;
+
+METRIC(checks)
+        // do a quick check for base 2
+        if (smallprimes[_mm_popcnt_u64(from)]) {
+METRIC(gate2)
+            // do a quick check for base 4
+            digitsum = _mm_popcnt_u64(from & 0x5555555555555555UL);
+            digitsum += (_mm_popcnt_u64(from & 0xAAAAAAAAAAAAAAAAUL)) << 1;
+            if (smallprimes[digitsum]) {
+METRIC(gate4)
+                // do a quick check for base 8
+                digitsum = _mm_popcnt_u64(from & 0x9249249249249249UL);
+                digitsum += (_mm_popcnt_u64(from & 0x2492492492492492UL)) << 1;
+                digitsum += (_mm_popcnt_u64(from & 0x4924924924924924UL)) << 2;
+                if (smallprimes[digitsum]) {
+METRIC(gate8)
+                    // do a quick check for base 16
+                    digitsum = _mm_popcnt_u64(from & 0x1111111111111111UL);
+                    digitsum += (_mm_popcnt_u64(from & 0x2222222222222222UL)) << 1;
+                    digitsum += (_mm_popcnt_u64(from & 0x4444444444444444UL)) << 2;
+                    digitsum += (_mm_popcnt_u64(from & 0x8888888888888888UL)) << 3;
+                    if (smallprimes[digitsum]) {
+METRIC(gate16)
+                        // do a quick check for base 32
+                        digitsum = _mm_popcnt_u64(from & 0x1084210842108421UL);
+                        digitsum += (_mm_popcnt_u64(from & 0x2108421084210842UL)) << 1;
+                        digitsum += (_mm_popcnt_u64(from & 0x4210842108421084UL)) << 2;
+                        digitsum += (_mm_popcnt_u64(from & 0x8421084210842108UL)) << 3;
+                        digitsum += (_mm_popcnt_u64(from & 0x0842108421084210UL)) << 4;
+                        if (smallprimes[digitsum]) {
+METRIC(gate32)
+METRIC(quick)
+                            // check other bases in the adaptive order
+                            if (checkOrder(from, order, radices, cache)) {
+METRIC(sums)
+                                if (from >= low && from <= to && isPrime(from)) {
+METRIC(primes)
+                                    return from;
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        // go to next value on the wheel
+        from += step4;
+
+METRIC(checks)
+        // do a quick check for base 2
+        if (smallprimes[_mm_popcnt_u64(from)]) {
+METRIC(gate2)
+            // do a quick check for base 4
+            digitsum = _mm_popcnt_u64(from & 0x5555555555555555UL);
+            digitsum += (_mm_popcnt_u64(from & 0xAAAAAAAAAAAAAAAAUL)) << 1;
+            if (smallprimes[digitsum]) {
+METRIC(gate4)
+                // do a quick check for base 8
+                digitsum = _mm_popcnt_u64(from & 0x9249249249249249UL);
+                digitsum += (_mm_popcnt_u64(from & 0x2492492492492492UL)) << 1;
+                digitsum += (_mm_popcnt_u64(from & 0x4924924924924924UL)) << 2;
+                if (smallprimes[digitsum]) {
+METRIC(gate8)
+                    // do a quick check for base 16
+                    digitsum = _mm_popcnt_u64(from & 0x1111111111111111UL);
+                    digitsum += (_mm_popcnt_u64(from & 0x2222222222222222UL)) << 1;
+                    digitsum += (_mm_popcnt_u64(from & 0x4444444444444444UL)) << 2;
+                    digitsum += (_mm_popcnt_u64(from & 0x8888888888888888UL)) << 3;
+                    if (smallprimes[digitsum]) {
+METRIC(gate16)
+                        // do a quick check for base 32
+                        digitsum = _mm_popcnt_u64(from & 0x1084210842108421UL);
+                        digitsum += (_mm_popcnt_u64(from & 0x2108421084210842UL)) << 1;
+                        digitsum += (_mm_popcnt_u64(from & 0x4210842108421084UL)) << 2;
+                        digitsum += (_mm_popcnt_u64(from & 0x8421084210842108UL)) << 3;
+                        digitsum += (_mm_popcnt_u64(from & 0x0842108421084210UL)) << 4;
+                        if (smallprimes[digitsum]) {
+METRIC(gate32)
+METRIC(quick)
+                            // check other bases in the adaptive order
+                            if (checkOrder(from, order, radices, cache)) {
+METRIC(sums)
+                                if (from >= low && from <= to && isPrime(from)) {
+METRIC(primes)
+                                    return from;
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        // go to next value on the wheel
+        from += step5;
+
+METRIC(checks)
+        // do a quick check for base 2
+        if (smallprimes[_mm_popcnt_u64(from)]) {
+METRIC(gate2)
+            // do a quick check for base 4
+            digitsum = _mm_popcnt_u64(from & 0x5555555555555555UL);
+            digitsum += (_mm_popcnt_u64(from & 0xAAAAAAAAAAAAAAAAUL)) << 1;
+            if (smallprimes[digitsum]) {
+METRIC(gate4)
+                // do a quick check for base 8
+                digitsum = _mm_popcnt_u64(from & 0x9249249249249249UL);
+                digitsum += (_mm_popcnt_u64(from & 0x2492492492492492UL)) << 1;
+                digitsum += (_mm_popcnt_u64(from & 0x4924924924924924UL)) << 2;
+                if (smallprimes[digitsum]) {
+METRIC(gate8)
+                    // do a quick check for base 16
+                    digitsum = _mm_popcnt_u64(from & 0x1111111111111111UL);
+                    digitsum += (_mm_popcnt_u64(from & 0x2222222222222222UL)) << 1;
+                    digitsum += (_mm_popcnt_u64(from & 0x4444444444444444UL)) << 2;
+                    digitsum += (_mm_popcnt_u64(from & 0x8888888888888888UL)) << 3;
+                    if (smallprimes[digitsum]) {
+METRIC(gate16)
+                        // do a quick check for base 32
+                        digitsum = _mm_popcnt_u64(from & 0x1084210842108421UL);
+                        digitsum += (_mm_popcnt_u64(from & 0x2108421084210842UL)) << 1;
+                        digitsum += (_mm_popcnt_u64(from & 0x4210842108421084UL)) << 2;
+                        digitsum += (_mm_popcnt_u64(from & 0x8421084210842108UL)) << 3;
+                        digitsum += (_mm_popcnt_u64(from & 0x0842108421084210UL)) << 4;
+                        if (smallprimes[digitsum]) {
+METRIC(gate32)
+METRIC(quick)
+                            // check other bases in the adaptive order
+                            if (checkOrder(from, order, radices, cache)) {
+METRIC(sums)
+                                if (from >= low && from <= to && isPrime(from)) {
+METRIC(primes)
+                                    return from;
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        // go to next value on the wheel
+        from += step6;
+
+METRIC(checks)
+        // do a quick check for base 2
+        if (smallprimes[_mm_popcnt_u64(from)]) {
+METRIC(gate2)
+            // do a quick check for base 4
+            digitsum = _mm_popcnt_u64(from & 0x5555555555555555UL);
+            digitsum += (_mm_popcnt_u64(from & 0xAAAAAAAAAAAAAAAAUL)) << 1;
+            if (smallprimes[digitsum]) {
+METRIC(gate4)
+                // do a quick check for base 8
+                digitsum = _mm_popcnt_u64(from & 0x9249249249249249UL);
+                digitsum += (_mm_popcnt_u64(from & 0x2492492492492492UL)) << 1;
+                digitsum += (_mm_popcnt_u64(from & 0x4924924924924924UL)) << 2;
+                if (smallprimes[digitsum]) {
+METRIC(gate8)
+                    // do a quick check for base 16
+                    digitsum = _mm_popcnt_u64(from & 0x1111111111111111UL);
+                    digitsum += (_mm_popcnt_u64(from & 0x2222222222222222UL)) << 1;
+                    digitsum += (_mm_popcnt_u64(from & 0x4444444444444444UL)) << 2;
+                    digitsum += (_mm_popcnt_u64(from & 0x8888888888888888UL)) << 3;
+                    if (smallprimes[digitsum]) {
+METRIC(gate16)
+                        // do a quick check for base 32
+                        digitsum = _mm_popcnt_u64(from & 0x1084210842108421UL);
+                        digitsum += (_mm_popcnt_u64(from & 0x2108421084210842UL)) << 1;
+                        digitsum += (_mm_popcnt_u64(from & 0x4210842108421084UL)) << 2;
+                        digitsum += (_mm_popcnt_u64(from & 0x8421084210842108UL)) << 3;
+                        digitsum += (_mm_popcnt_u64(from & 0x0842108421084210UL)) << 4;
+                        if (smallprimes[digitsum]) {
+METRIC(gate32)
+METRIC(quick)
+                            // check other bases in the adaptive order
+                            if (checkOrder(from, order, radices, cache)) {
+METRIC(sums)
+                                if (from >= low && from <= to && isPrime(from)) {
+METRIC(primes)
+                                    return from;
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        // go to next value on the wheel
+        from += step7;
+        step = (step + 8 == turn) ? 0 : step + 8;
+    }
+
+    // not found
+    return to + 1;
+}
+
+
+// checkRange32Plus without metrics
+uint64_t checkRange32Plus(uint64_t from, const uint64_t to, const uint32_t radix) {
+    return checkRange32PlusBody(from, to, radix, false);
+}
+
+
+// checkRange32Plus counting metrics
+uint64_t checkRange32PlusMetrics(uint64_t from, const uint64_t to, const uint32_t radix) {
+    return checkRange32PlusBody(from, to, radix, true);
+}
+
+
+// check primes in the given range for consecutive number base digit sum primes
+//       works for radix values >= 16 and < 31
+static inline __attribute__((always_inline)) uint64_t checkRange16To31Body(uint64_t from, const uint64_t to, const uint32_t radix, const bool metrics) {
+    Funnel *funnel = &threadMetrics.funnel[FUNNEL_16TO31];
+    DigitSumCache cache[51] = {{0}};
+    const uint32_t *steps = wheel.steps;
+    const uint32_t turn = wheel.count;
+    const uint64_t low = from;
+    uint32_t step = 0;
+    uint32_t digitsum = 0;
+    uint32_t order[51];
+    const uint32_t radices = loadRadixOrder(radix, order);
+
+    // start at the first candidate on the wheel backing up to the start of a group of 8 steps
+    // since the loop is unrolled for 8 steps (values before low are checked but not returned)
+    from = wheelStart(from, &step);
+    while (step & 7) {
+        step--;
+        from -= steps[step];
+    }
+
+    while (from <= to) {
+        // steps for this group of 8 candidates
+        const uint32_t step0 = steps[step];
+        const uint32_t step1 = steps[step + 1];
+        const uint32_t step2 = steps[step + 2];
+        const uint32_t step3 = steps[step + 3];
+        const uint32_t step4 = steps[step + 4];
+        const uint32_t step5 = steps[step + 5];
+        const uint32_t step6 = steps[step + 6];
+        const uint32_t step7 = steps[step + 7];
+
+METRIC(checks)
+        // do a quick check for base 2
+        if (smallprimes[_mm_popcnt_u64(from)]) {
+METRIC(gate2)
+            // do a quick check for base 4
+            digitsum = _mm_popcnt_u64(from & 0x5555555555555555UL);
+            digitsum += (_mm_popcnt_u64(from & 0xAAAAAAAAAAAAAAAAUL)) << 1;
+            if (smallprimes[digitsum]) {
+METRIC(gate4)
+                // do a quick check for base 8
+                digitsum = _mm_popcnt_u64(from & 0x9249249249249249UL);
+                digitsum += (_mm_popcnt_u64(from & 0x2492492492492492UL)) << 1;
+                digitsum += (_mm_popcnt_u64(from & 0x4924924924924924UL)) << 2;
+                if (smallprimes[digitsum]) {
+METRIC(gate8)
+                    // do a quick check for base 16
+                    digitsum = _mm_popcnt_u64(from & 0x1111111111111111UL);
+                    digitsum += (_mm_popcnt_u64(from & 0x2222222222222222UL)) << 1;
+                    digitsum += (_mm_popcnt_u64(from & 0x4444444444444444UL)) << 2;
+                    digitsum += (_mm_popcnt_u64(from & 0x8888888888888888UL)) << 3;
+                    if (smallprimes[digitsum]) {
+METRIC(gate16)
+METRIC(quick)
+                        // check other bases in the adaptive order
+                        if (checkOrder(from, order, radices, cache)) {
+METRIC(sums)
+                            if (from >= low && from <= to && isPrime(from)) {
+METRIC(primes)
+                                return from;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        // go to next value on the wheel
+        from += step0;
+
+METRIC(checks)
+        // do a quick check for base 2
+        if (smallprimes[_mm_popcnt_u64(from)]) {
+METRIC(gate2)
+            // do a quick check for base 4
+            digitsum = _mm_popcnt_u64(from & 0x5555555555555555UL);
+            digitsum += (_mm_popcnt_u64(from & 0xAAAAAAAAAAAAAAAAUL)) << 1;
+            if (smallprimes[digitsum]) {
+METRIC(gate4)
+                // do a quick check for base 8
+                digitsum = _mm_popcnt_u64(from & 0x9249249249249249UL);
+                digitsum += (_mm_popcnt_u64(from & 0x2492492492492492UL)) << 1;
+                digitsum += (_mm_popcnt_u64(from & 0x4924924924924924UL)) << 2;
+                if (smallprimes[digitsum]) {
+METRIC(gate8)
+                    // do a quick check for base 16
+                    digitsum = _mm_popcnt_u64(from & 0x1111111111111111UL);
+                    digitsum += (_mm_popcnt_u64(from & 0x2222222222222222UL)) << 1;
+                    digitsum += (_mm_popcnt_u64(from & 0x4444444444444444UL)) << 2;
+                    digitsum += (_mm_popcnt_u64(from & 0x8888888888888888UL)) << 3;
+                    if (smallprimes[digitsum]) {
+METRIC(gate16)
+METRIC(quick)
+                        // check other bases in the adaptive order
+                        if (checkOrder(from, order, radices, cache)) {
+METRIC(sums)
+                            if (from >= low && from <= to && isPrime(from)) {
+METRIC(primes)
+                                return from;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        // go to next value on the wheel
+        from += step1;
+
+METRIC(checks)
+        // do a quick check for base 2
+        if (smallprimes[_mm_popcnt_u64(from)]) {
+METRIC(gate2)
+            // do a quick check for base 4
+            digitsum = _mm_popcnt_u64(from & 0x5555555555555555UL);
+            digitsum += (_mm_popcnt_u64(from & 0xAAAAAAAAAAAAAAAAUL)) << 1;
+            if (smallprimes[digitsum]) {
+METRIC(gate4)
+                // do a quick check for base 8
+                digitsum = _mm_popcnt_u64(from & 0x9249249249249249UL);
+                digitsum += (_mm_popcnt_u64(from & 0x2492492492492492UL)) << 1;
+                digitsum += (_mm_popcnt_u64(from & 0x4924924924924924UL)) << 2;
+                if (smallprimes[digitsum]) {
+METRIC(gate8)
+                    // do a quick check for base 16
+                    digitsum = _mm_popcnt_u64(from & 0x1111111111111111UL);
+                    digitsum += (_mm_popcnt_u64(from & 0x2222222222222222UL)) << 1;
+                    digitsum += (_mm_popcnt_u64(from & 0x4444444444444444UL)) << 2;
+                    digitsum += (_mm_popcnt_u64(from & 0x8888888888888888UL)) << 3;
+                    if (smallprimes[digitsum]) {
+METRIC(gate16)
+METRIC(quick)
+                        // check other bases in the adaptive order
+                        if (checkOrder(from, order, radices, cache)) {
+METRIC(sums)
+                            if (from >= low && from <= to && isPrime(from)) {
+METRIC(primes)
+                                return from;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        // go to next value on the wheel
+        from += step2;
+
+METRIC(checks)
+        // do a quick check for base 2
+        if (smallprimes[_mm_popcnt_u64(from)]) {
+METRIC(gate2)
+            // do a quick check for base 4
+            digitsum = _mm_popcnt_u64(from & 0x5555555555555555UL);
+            digitsum += (_mm_popcnt_u64(from & 0xAAAAAAAAAAAAAAAAUL)) << 1;
+            if (smallprimes[digitsum]) {
+METRIC(gate4)
+                // do a quick check for base 8
+                digitsum = _mm_popcnt_u64(from & 0x9249249249249249UL);
+                digitsum += (_mm_popcnt_u64(from & 0x2492492492492492UL)) << 1;
+                digitsum += (_mm_popcnt_u64(from & 0x4924924924924924UL)) << 2;
+                if (smallprimes[digitsum]) {
+METRIC(gate8)
+                    // do a quick check for base 16
+                    digitsum = _mm_popcnt_u64(from & 0x1111111111111111UL);
+                    digitsum += (_mm_popcnt_u64(from & 0x2222222222222222UL)) << 1;
+                    digitsum += (_mm_popcnt_u64(from & 0x4444444444444444UL)) << 2;
+                    digitsum += (_mm_popcnt_u64(from & 0x8888888888888888UL)) << 3;
+                    if (smallprimes[digitsum]) {
+METRIC(gate16)
+METRIC(quick)
+                        // check other bases in the adaptive order
+                        if (checkOrder(from, order, radices, cache)) {
+METRIC(sums)
+                            if (from >= low && from <= to && isPrime(from)) {
+METRIC(primes)
+                                return from;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        // go to next value on the wheel
+        from += step3;
+
+METRIC(checks)
+        // do a quick check for base 2
+        if (smallprimes[_mm_popcnt_u64(from)]) {
+METRIC(gate2)
+            // do a quick check for base 4
+            digitsum = _mm_popcnt_u64(from & 0x5555555555555555UL);
+            digitsum += (_mm_popcnt_u64(from & 0xAAAAAAAAAAAAAAAAUL)) << 1;
+            if (smallprimes[digitsum]) {
+METRIC(gate4)
+                // do a quick check for base 8
+                digitsum = _mm_popcnt_u64(from & 0x9249249249249249UL);
+                digitsum += (_mm_popcnt_u64(from & 0x2492492492492492UL)) << 1;
+                digitsum += (_mm_popcnt_u64(from & 0x4924924924924924UL)) << 2;
+                if (smallprimes[digitsum]) {
+METRIC(gate8)
+                    // do a quick check for base 16
+                    digitsum = _mm_popcnt_u64(from & 0x1111111111111111UL);
+                    digitsum += (_mm_popcnt_u64(from & 0x2222222222222222UL)) << 1;
+                    digitsum += (_mm_popcnt_u64(from & 0x4444444444444444UL)) << 2;
+                    digitsum += (_mm_popcnt_u64(from & 0x8888888888888888UL)) << 3;
+                    if (smallprimes[digitsum]) {
+METRIC(gate16)
+METRIC(quick)
+                        // check other bases in the adaptive order
+                        if (checkOrder(from, order, radices, cache)) {
+METRIC(sums)
+                            if (from >= low && from <= to && isPrime(from)) {
+METRIC(primes)
+                                return from;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        // go to next value on the wheel
+        from += step4;
+
+METRIC(checks)
+        // do a quick check for base 2
+        if (smallprimes[_mm_popcnt_u64(from)]) {
+METRIC(gate2)
+            // do a quick check for base 4
+            digitsum = _mm_popcnt_u64(from & 0x5555555555555555UL);
+            digitsum += (_mm_popcnt_u64(from & 0xAAAAAAAAAAAAAAAAUL)) << 1;
+            if (smallprimes[digitsum]) {
+METRIC(gate4)
+                // do a quick check for base 8
+                digitsum = _mm_popcnt_u64(from & 0x9249249249249249UL);
+                digitsum += (_mm_popcnt_u64(from & 0x2492492492492492UL)) << 1;
+                digitsum += (_mm_popcnt_u64(from & 0x4924924924924924UL)) << 2;
+                if (smallprimes[digitsum]) {
+METRIC(gate8)
+                    // do a quick check for base 16
+                    digitsum = _mm_popcnt_u64(from & 0x1111111111111111UL);
+                    digitsum += (_mm_popcnt_u64(from & 0x2222222222222222UL)) << 1;
+                    digitsum += (_mm_popcnt_u64(from & 0x4444444444444444UL)) << 2;
+                    digitsum += (_mm_popcnt_u64(from & 0x8888888888888888UL)) << 3;
+                    if (smallprimes[digitsum]) {
+METRIC(gate16)
+METRIC(quick)
+                        // check other bases in the adaptive order
+                        if (checkOrder(from, order, radices, cache)) {
+METRIC(sums)
+                            if (from >= low && from <= to && isPrime(from)) {
+METRIC(primes)
+                                return from;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        // go to next value on the wheel
+        from += step5;
+
+METRIC(checks)
+        // do a quick check for base 2
+        if (smallprimes[_mm_popcnt_u64(from)]) {
+METRIC(gate2)
+            // do a quick check for base 4
+            digitsum = _mm_popcnt_u64(from & 0x5555555555555555UL);
+            digitsum += (_mm_popcnt_u64(from & 0xAAAAAAAAAAAAAAAAUL)) << 1;
+            if (smallprimes[digitsum]) {
+METRIC(gate4)
+                // do a quick check for base 8
+                digitsum = _mm_popcnt_u64(from & 0x9249249249249249UL);
+                digitsum += (_mm_popcnt_u64(from & 0x2492492492492492UL)) << 1;
+                digitsum += (_mm_popcnt_u64(from & 0x4924924924924924UL)) << 2;
+                if (smallprimes[digitsum]) {
+METRIC(gate8)
+                    // do a quick check for base 16
+                    digitsum = _mm_popcnt_u64(from & 0x1111111111111111UL);
+                    digitsum += (_mm_popcnt_u64(from & 0x2222222222222222UL)) << 1;
+                    digitsum += (_mm_popcnt_u64(from & 0x4444444444444444UL)) << 2;
+                    digitsum += (_mm_popcnt_u64(from & 0x8888888888888888UL)) << 3;
+                    if (smallprimes[digitsum]) {
+METRIC(gate16)
+METRIC(quick)
+                        // check other bases in the adaptive order
+                        if (checkOrder(from, order, radices, cache)) {
+METRIC(sums)
+                            if (from >= low && from <= to && isPrime(from)) {
+METRIC(primes)
+                                return from;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        // go to next value on the wheel
+        from += step6;
+
+METRIC(checks)
+        // do a quick check for base 2
+        if (smallprimes[_mm_popcnt_u64(from)]) {
+METRIC(gate2)
+            // do a quick check for base 4
+            digitsum = _mm_popcnt_u64(from & 0x5555555555555555UL);
+            digitsum += (_mm_popcnt_u64(from & 0xAAAAAAAAAAAAAAAAUL)) << 1;
+            if (smallprimes[digitsum]) {
+METRIC(gate4)
+                // do a quick check for base 8
+                digitsum = _mm_popcnt_u64(from & 0x9249249249249249UL);
+                digitsum += (_mm_popcnt_u64(from & 0x2492492492492492UL)) << 1;
+                digitsum += (_mm_popcnt_u64(from & 0x4924924924924924UL)) << 2;
+                if (smallprimes[digitsum]) {
+METRIC(gate8)
+                    // do a quick check for base 16
+                    digitsum = _mm_popcnt_u64(from & 0x1111111111111111UL);
+                    digitsum += (_mm_popcnt_u64(from & 0x2222222222222222UL)) << 1;
+                    digitsum += (_mm_popcnt_u64(from & 0x4444444444444444UL)) << 2;
+                    digitsum += (_mm_popcnt_u64(from & 0x8888888888888888UL)) << 3;
+                    if (smallprimes[digitsum]) {
+METRIC(gate16)
+METRIC(quick)
+                        // check other bases in the adaptive order
+                        if (checkOrder(from, order, radices, cache)) {
+METRIC(sums)
+                            if (from >= low && from <= to && isPrime(from)) {
+METRIC(primes)
+                                return from;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        // go to next value on the wheel
+        from += step7;
+        step = (step + 8 == turn) ? 0 : step + 8;
+    }
+
+    // not found
+    return to + 1;
+}
+
+
+// checkRange16To31 without metrics
+uint64_t checkRange16To31(uint64_t from, const uint64_t to, const uint32_t radix) {
+    return checkRange16To31Body(from, to, radix, false);
+}
+
+
+// checkRange16To31 counting metrics
+uint64_t checkRange16To31Metrics(uint64_t from, const uint64_t to, const uint32_t radix) {
+    return checkRange16To31Body(from, to, radix, true);
+}
+
+
+// check primes in the given range for consecutive number base digit sum primes
+//       works for radix values < 16
+static inline __attribute__((always_inline)) uint64_t checkRangeSub16Body(uint64_t from, const uint64_t to, const uint32_t radix, const bool metrics) {
+    Funnel *funnel = &threadMetrics.funnel[FUNNEL_SUB16];
+    DigitSumCache cache[51] = {{0}};
+    const uint32_t *steps = wheel.steps;
+    const uint32_t turn = wheel.count;
+    const uint64_t low = from;
+    uint32_t step = 0;
+    bool allprime = false;
+    uint32_t order[51];
+    const uint32_t radices = loadRadixOrder(radix, order);
+
+    // start at the first candidate on the wheel backing up to the start of a group of 8 steps
+    // since the loop is unrolled for 8 steps (values before low are checked but not returned)
+    from = wheelStart(from, &step);
+    while (step & 7) {
+        step--;
+        from -= steps[step];
+    }
+
+    while (from <= to) {
+        // steps for this group of 8 candidates
+        const uint32_t step0 = steps[step];
+        const uint32_t step1 = steps[step + 1];
+        const uint32_t step2 = steps[step + 2];
+        const uint32_t step3 = steps[step + 3];
+        const uint32_t step4 = steps[step + 4];
+        const uint32_t step5 = steps[step + 5];
+        const uint32_t step6 = steps[step + 6];
+        const uint32_t step7 = steps[step + 7];
+
+METRIC(checks)
+        // do a quick check for base 2
+        uint32_t digitsum = _mm_popcnt_u64(from);
+        allprime = smallprimes[digitsum];
+        if (allprime && radix >= 4) {
+METRIC(gate2)
+            // do a quick check for base 4
+            digitsum = _mm_popcnt_u64(from & 0x5555555555555555UL);
+            digitsum += (_mm_popcnt_u64(from & 0xAAAAAAAAAAAAAAAAUL)) << 1;
+            allprime = smallprimes[digitsum];
+            if (allprime && radix >= 8) {
+METRIC(gate4)
+                // do a quick check for base 8
+                digitsum = _mm_popcnt_u64(from & 0x9249249249249249UL);
+                digitsum += (_mm_popcnt_u64(from & 0x2492492492492492UL)) << 1;
+                digitsum += (_mm_popcnt_u64(from & 0x4924924924924924UL)) << 2;
+                allprime = smallprimes[digitsum];
+            }
+        }
+
+        // if quick tests passed then try other bases
+        if (allprime) {
+METRIC(quick)
+            // check other bases in the adaptive order
+            allprime = checkOrder(from, order, radices, cache);
+            if (allprime) {
+METRIC(sums)
+                if (from >= low && from <= to && isPrime(from)) {
+METRIC(primes)
+                    return from;
+                }
+            }
+        }
+
+        // go to next value on the wheel
+        from += step0;
+
+METRIC(checks)
+        // do a quick check for base 2
+        digitsum = _mm_popcnt_u64(from);
+        allprime = smallprimes[digitsum];
+        if (allprime && radix >= 4) {
+METRIC(gate2)
+            // do a quick check for base 4
+            digitsum = _mm_popcnt_u64(from & 0x5555555555555555UL);
+            digitsum += (_mm_popcnt_u64(from & 0xAAAAAAAAAAAAAAAAUL)) << 1;
+            allprime = smallprimes[digitsum];
+            if (allprime && radix >= 8) {
+METRIC(gate4)
+                // do a quick check for base 8
+                digitsum = _mm_popcnt_u64(from & 0x9249249249249249UL);
+                digitsum += (_mm_popcnt_u64(from & 0x2492492492492492UL)) << 1;
+                digitsum += (_mm_popcnt_u64(from & 0x4924924924924924UL)) << 2;
+                allprime = smallprimes[digitsum];
+            }
+        }
+
+        // if quick tests passed then try other bases
+        if (allprime) {
+METRIC(quick)
+            // check other bases in the adaptive order
+            allprime = checkOrder(from, order, radices, cache);
+            if (allprime) {
+METRIC(sums)
+                if (from >= low && from <= to && isPrime(from)) {
+METRIC(primes)
+                    return from;
+                }
+            }
+        }
+
+        // go to next value on the wheel
+        from += step1;
+
+METRIC(checks)
+        // do a quick check for base 2
+        digitsum = _mm_popcnt_u64(from);
+        allprime = smallprimes[digitsum];
+        if (allprime && radix >= 4) {
+METRIC(gate2)
+            // do a quick check for base 4
+            digitsum = _mm_popcnt_u64(from & 0x5555555555555555UL);
+            digitsum += (_mm_popcnt_u64(from & 0xAAAAAAAAAAAAAAAAUL)) << 1;
+            allprime = smallprimes[digitsum];
+            if (allprime && radix >= 8) {
+METRIC(gate4)
+                // do a quick check for base 8
+                digitsum = _mm_popcnt_u64(from & 0x9249249249249249UL);
+                digitsum += (_mm_popcnt_u64(from & 0x2492492492492492UL)) << 1;
+                digitsum += (_mm_popcnt_u64(from & 0x4924924924924924UL)) << 2;
+                allprime = smallprimes[digitsum];
+            }
+        }
+
+        // if quick tests passed then try other bases
+        if (allprime) {
+METRIC(quick)
+            // check other bases in the adaptive order
+            allprime = checkOrder(from, order, radices, cache);
+            if (allprime) {
+METRIC(sums)
+                if (from >= low && from <= to && isPrime(from)) {
+METRIC(primes)
+                    return from;
+                }
+            }
+        }
+
+        // go to next value on the wheel
+        from += step2;
+
+METRIC(checks)
+        // do a quick check for base 2
+        digitsum = _mm_popcnt_u64(from);
+        allprime = smallprimes[digitsum];
+        if (allprime && radix >= 4) {
+METRIC(gate2)
+            // do a quick check for base 4
             digitsum = _mm_popcnt_u64(from & 0x5555555555555555UL);
             digitsum += (_mm_popcnt_u64(from & 0xAAAAAAAAAAAAAAAAUL)) << 1;
-            if (smallprimes[digitsum]) {
+            allprime = smallprimes[digitsum];
+            if (allprime && radix >= 8) {
 METRIC(gate4)
                 // do a quick check for base 8
                 digitsum = _mm_popcnt_u64(from & 0x9249249249249249UL);
                 digitsum += (_mm_popcnt_u64(from & 0x2492492492492492UL)) << 1;
                 digitsum += (_mm_popcnt_u64(from & 0x4924924924924924UL)) << 2;
-                if (smallprimes[digitsum]) {
-METRIC(gate8)
-                    // do a quick check for base 16
-                    digitsum = _mm_popcnt_u64(from & 0x1111111111111111UL);
-                    digitsum += (_mm_popcnt_u64(from & 0x2222222222222222UL)) << 1;
-                    digitsum += (_mm_popcnt_u64(from & 0x4444444444444444UL)) << 2;
-                    digitsum += (_mm_popcnt_u64(from & 0x8888888888888888UL)) << 3;
-                    if (smallprimes[digitsum]) {
-METRIC(gate16)
-                        // do a quick check for base 32
-                        digitsum = _mm_popcnt_u64(from & 0x1084210842108421UL);
-                        digitsum += (_mm_popcnt_u64(from & 0x2108421084210842UL)) << 1;
-                        digitsum += (_mm_popcnt_u64(from & 0x4210842108421084UL)) << 2;
-                        digitsum += (_mm_popcnt_u64(from & 0x8421084210842108UL)) << 3;
-                        digitsum += (_mm_popcnt_u64(from & 0x0842108421084210UL)) << 4;
-                        if (smallprimes[digitsum]) {
-METRIC(gate32)
-                            // check other bases starting at the largest since it will have fewest digits
-                            r = reven;
-                            while (r > 2 && sumDigitsIsPrime(from, r)) {
-                                r -= 2;
-                            }
-                            if (r == 2) { 
-                                r = rodd;
-                                while (r > 1 && sumDigitsIsPrime(from, r)) {
-                                    r -= 2;
-                                }
-                                if (r == 1) {
+                allprime = smallprimes[digitsum];
+            }
+        }
+
+        // if quick tests passed then try other bases
+        if (allprime) {
+METRIC(quick)
+            // check other bases in the adaptive order
+            allprime = checkOrder(from, order, radices, cache);
+            if (allprime) {
+METRIC(sums)
+                if (from >= low && from <= to && isPrime(from)) {
+METRIC(primes)
+                    return from;
+                }
+            }
+        }
+
+        // go to next value on the wheel
+        from += step3;
+
+METRIC(checks)
+        // do a quick check for base 2
+        digitsum = _mm_popcnt_u64(from);
+        allprime = smallprimes[digitsum];
+        if (allprime && radix >= 4) {
+METRIC(gate2)
+            // do a quick check for base 4
+            digitsum = _mm_popcnt_u64(from & 0x5555555555555555UL);
+            digitsum += (_mm_popcnt_u64(from & 0xAAAAAAAAAAAAAAAAUL)) << 1;
+            allprime = smallprimes[digitsum];
+            if (allprime && radix >= 8) {
+METRIC(gate4)
+                // do a quick check for base 8
+                digitsum = _mm_popcnt_u64(from & 0x9249249249249249UL);
+                digitsum += (_mm_popcnt_u64(from & 0x2492492492492492UL)) << 1;
+                digitsum += (_mm_popcnt_u64(from & 0x4924924924924924UL)) << 2;
+                allprime = smallprimes[digitsum];
+            }
+        }
+
+        // if quick tests passed then try other bases
+        if (allprime) {
+METRIC(quick)
+            // check other bases in the adaptive order
+            allprime = checkOrder(from, order, radices, cache);
+            if (allprime) {
+METRIC(sums)
+                if (from >= low && from <= to && isPrime(from)) {
+METRIC(primes)
+                    return from;
+                }
+            }
+        }
+
+        // go to next value on the wheel
+        from += step4;
+
+METRIC(checks)
+        // do a quick check for base 2
+        digitsum = _mm_popcnt_u64(from);
+        allprime = smallprimes[digitsum];
+        if (allprime && radix >= 4) {
+METRIC(gate2)
+            // do a quick check for base 4
+            digitsum = _mm_popcnt_u64(from & 0x5555555555555555UL);
+            digitsum += (_mm_popcnt_u64(from & 0xAAAAAAAAAAAAAAAAUL)) << 1;
+            allprime = smallprimes[digitsum];
+            if (allprime && radix >= 8) {
+METRIC(gate4)
+                // do a quick check for base 8
+                digitsum = _mm_popcnt_u64(from & 0x9249249249249249UL);
+                digitsum += (_mm_popcnt_u64(from & 0x2492492492492492UL)) << 1;
+                digitsum += (_mm_popcnt_u64(from & 0x4924924924924924UL)) << 2;
+                allprime = smallprimes[digitsum];
+            }
+        }
+
+        // if quick tests passed then try other bases
+        if (allprime) {
+METRIC(quick)
+            // check other bases in the adaptive order
+            allprime = checkOrder(from, order, radices, cache);
+            if (allprime) {
+METRIC(sums)
+                if (from >= low && from <= to && isPrime(from)) {
+METRIC(primes)
+                    return from;
+                }
+            }
+        }
+
+        // go to next value on the wheel
+        from += step5;
+
+METRIC(checks)
+        // do a quick check for base 2
+        digitsum = _mm_popcnt_u64(from);
+        allprime = smallprimes[digitsum];
+        if (allprime && radix >= 4) {
+METRIC(gate2)
+            // do a quick check for base 4
+            digitsum = _mm_popcnt_u64(from & 0x5555555555555555UL);
+            digitsum += (_mm_popcnt_u64(from & 0xAAAAAAAAAAAAAAAAUL)) << 1;
+            allprime = smallprimes[digitsum];
+            if (allprime && radix >= 8) {
+METRIC(gate4)
+                // do a quick check for base 8
+                digitsum = _mm_popcnt_u64(from & 0x9249249249249249UL);
+                digitsum += (_mm_popcnt_u64(from & 0x2492492492492492UL)) << 1;
+                digitsum += (_mm_popcnt_u64(from & 0x4924924924924924UL)) << 2;
+                allprime = smallprimes[digitsum];
+            }
+        }
+
+        // if quick tests passed then try other bases
+        if (allprime) {
+METRIC(quick)
+            // check other bases in the adaptive order
+            allprime = checkOrder(from, order, radices, cache);
+            if (allprime) {
+METRIC(sums)
+                if (from >= low && from <= to && isPrime(from)) {
+METRIC(primes)
+                    return from;
+                }
+            }
+        }
+
+        // go to next value on the wheel
+        from += step6;
+
+METRIC(checks)
+        // do a quick check for base 2
+        digitsum = _mm_popcnt_u64(from);
+        allprime = smallprimes[digitsum];
+        if (allprime && radix >= 4) {
+METRIC(gate2)
+            // do a quick check for base 4
+            digitsum = _mm_popcnt_u64(from & 0x5555555555555555UL);
+            digitsum += (_mm_popcnt_u64(from & 0xAAAAAAAAAAAAAAAAUL)) << 1;
+            allprime = smallprimes[digitsum];
+            if (allprime && radix >= 8) {
+METRIC(gate4)
+                // do a quick check for base 8
+                digitsum = _mm_popcnt_u64(from & 0x9249249249249249UL);
+                digitsum += (_mm_popcnt_u64(from & 0x2492492492492492UL)) << 1;
+                digitsum += (_mm_popcnt_u64(from & 0x4924924924924924UL)) << 2;
+                allprime = smallprimes[digitsum];
+            }
+        }
+
+        // if quick tests passed then try other bases
+        if (allprime) {
+METRIC(quick)
+            // check other bases in the adaptive order
+            allprime = checkOrder(from, order, radices, cache);
+            if (allprime) {
+METRIC(sums)
+                if (from >= low && from <= to && isPrime(from)) {
+METRIC(primes)
+                    return from;
+                }
+            }
+        }
+
+        // go to next value on the wheel
+        from += step7;
+        step = (step + 8 == turn) ? 0 : step + 8;
+    }
+
+    // not found
+    return to + 1;
+}
+
+
+// checkRangeSub16 without metrics
+uint64_t checkRangeSub16(uint64_t from, const uint64_t to, const uint32_t radix) {
+    return checkRangeSub16Body(from, to, radix, false);
+}
+
+
+// checkRangeSub16 counting metrics
+uint64_t checkRangeSub16Metrics(uint64_t from, const uint64_t to, const uint32_t radix) {
+    return checkRangeSub16Body(from, to, radix, true);
+}
+
+
+// initialize fast prime lookup for digit sums
+void initPrimes(const uint32_t base) {
+    // calculate maximum number of digits in the given base
+    uint32_t number = ceil(log((double)ULLONG_MAX) / log((double)base));
+
+    // calculate the largest digit sum
+    uint32_t largestds = number * (base - 1);
+
+    // allocate primes array (large enough for the bitmap below too)
+    uint32_t size = largestds > 512 ? largestds : 512;
+    bool *sieve = (bool *)malloc(size * sizeof(*sieve));
+    smallprimes = (bool *)calloc(largestds, sizeof(*smallprimes));
+    if (!sieve || !smallprimes) {
+        fprintf(stderr, "Fatal: malloc failed for primes\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // sieve the small primes
+    memset(sieve, true, size * sizeof(*sieve));
+    sieve[0] = sieve[1] = false;
+    for (uint32_t i = 2; i * i < size; i++) {
+        if (sieve[i]) {
+            for (uint32_t j = i * i; j < size; j += i) {
+                sieve[j] = false;
+            }
+        }
+    }
+
+    // populate primes array
+    memcpy(smallprimes, sieve, largestds * sizeof(*smallprimes));
+
+    // populate primes bitmap (covers every digit sum for the power of 2 radices)
+    for (uint32_t i = 2; i < 512; i++) {
+        smallprimeBits[i >> 6] |= (uint64_t)sieve[i] << (i & 63);
+    }
+    free(sieve);
+
+    printf("Cached primes up to %u\n", largestds);
+}
+
+
+// free fast prime lookup for digit sums
+void freePrimes() {
+    // free primes memory
+    free(smallprimes);
+    smallprimes = NULL;
+}
+
+
+// number of candidates gated at a time (whole wheel turns are gated so a turn must fit)
+#define GATE_CANDIDATES 4096
+
+
+// largest power of 2 radix gate used by the kernel for the given radix
+static inline uint32_t gateLimit(const uint32_t radix) {
+    if (radix >= 32) return 32;
+    if (radix >= 16) return 16;
+    if (radix >= 8) return 8;
+    if (radix >= 4) return 4;
+    return 2;
+}
+
+
+// funnel counting the metrics of the kernel with the given first funnel for the given radix
+static inline Funnel *gateFunnel(const uint32_t first, const uint32_t radix) {
+    return &threadMetrics.funnel[first + __builtin_ctz(gateLimit(radix)) - 1];
+}
+
+
+// return whether the digit sum of a power of 2 radix is prime given the mask of the lowest bit of each digit
+static inline bool powerSumIsPrime(const uint64_t number, const uint64_t ones, const uint32_t bits) {
+    uint32_t sum = _mm_popcnt_u64(number & ones);
+
+    for (uint32_t i = 1; i < bits; i++) {
+        sum += _mm_popcnt_u64(number & (ones << i)) << i;
+    }
+
+    return (smallprimeBits[sum >> 6] >> (sum & 63)) & 1;
+}
+
+
+#if defined(__AVX512F__) && defined(__AVX512VPOPCNTDQ__)
+#define VECTOR_KERNEL "AVX-512"
+
+// vector gates are faster than POPCNT so use them by default
+#define VECTOR_DEFAULT
+
+// return which lanes hold a prime digit sum using the prime bitmap held in a register
+static inline __mmask8 primeLanes(const __m512i primes, const __m512i sum) {
+    __m512i word = _mm512_permutexvar_epi64(_mm512_srli_epi64(sum, 6), primes);
+    __m512i bit = _mm512_srlv_epi64(word, _mm512_and_si512(sum, _mm512_set1_epi64(63)));
+
+    return _mm512_test_epi64_mask(bit, _mm512_set1_epi64(1));
+}
+
+
+// digit sum of each lane for a power of 2 radix given the mask of the lowest bit of each digit
+static inline __m512i powerSum(const __m512i number, const uint64_t ones, const uint32_t bits) {
+    __m512i sum = _mm512_popcnt_epi64(_mm512_and_si512(number, _mm512_set1_epi64(ones)));
+
+    for (uint32_t i = 1; i < bits; i++) {
+        __m512i count = _mm512_popcnt_epi64(_mm512_and_si512(number, _mm512_set1_epi64(ones << i)));
+        sum = _mm512_add_epi64(sum, _mm512_slli_epi64(count, i));
+    }
+
+    return sum;
+}
+
+
+// gate the given number of wheel turns from "from" (the start of a turn) keeping values from "low" to "to"
+// on the power of 2 radices up to gates storing the candidates that pass in order and returning how many passed
+// (counting each gate in the funnel given when metrics is true)
+static inline __attribute__((always_inline)) uint32_t gateTurns(uint64_t from, const uint64_t low, const uint64_t to, const uint32_t turns, const uint32_t gates, uint64_t *survivors, const bool metrics, Funnel *funnel) {
+    const __m512i primes = _mm512_loadu_si512(smallprimeBits);
+    const __m512i first = _mm512_set1_epi64(low);
+    const __m512i last = _mm512_set1_epi64(to);
+    __m512i number;
+    __mmask8 pass = 0;
+    uint32_t count = 0;
+
+    for (uint32_t turn = 0; turn < turns; turn++) {
+        for (uint32_t lane = 0; lane < wheel.count; lane += 8) {
+            number = _mm512_add_epi64(_mm512_set1_epi64(from), _mm512_loadu_si512(wheel.offsets + lane));
+            pass = _mm512_cmpge_epu64_mask(number, first) & _mm512_cmple_epu64_mask(number, last);
+METRIC_ADD(checks, _mm_popcnt_u32(pass))
+            pass &= primeLanes(primes, _mm512_popcnt_epi64(number));
+METRIC_ADD(gate2, _mm_popcnt_u32(pass))
+            if (gates >= 4) {
+                pass &= primeLanes(primes, powerSum(number, 0x5555555555555555UL, 2));
+METRIC_ADD(gate4, _mm_popcnt_u32(pass))
+            }
+            if (gates >= 8) {
+                pass &= primeLanes(primes, powerSum(number, 0x9249249249249249UL, 3));
+METRIC_ADD(gate8, _mm_popcnt_u32(pass))
+            }
+            if (gates >= 16) {
+                pass &= primeLanes(primes, powerSum(number, 0x1111111111111111UL, 4));
+METRIC_ADD(gate16, _mm_popcnt_u32(pass))
+            }
+            if (gates >= 32) {
+                pass &= primeLanes(primes, powerSum(number, 0x1084210842108421UL, 5));
+METRIC_ADD(gate32, _mm_popcnt_u32(pass))
+            }
+
+            // store the survivors
+            _mm512_mask_compressstoreu_epi64(survivors + count, pass, number);
+            count += _mm_popcnt_u32(pass);
+        }
+        from += wheel.modulus;
+    }
+
+    return count;
+}
+
+#elif defined(__AVX2__)
+#define VECTOR_KERNEL "AVX2"
+
+// population count of each 64 bit lane using a nibble lookup table
+static inline __m256i popcount256(const __m256i number) {
+    const __m256i table = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                           0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+    __m256i low = _mm256_shuffle_epi8(table, _mm256_and_si256(number, nibble));
+    __m256i high = _mm256_shuffle_epi8(table, _mm256_and_si256(_mm256_srli_epi16(number, 4), nibble));
+
+    return _mm256_sad_epu8(_mm256_add_epi8(low, high), _mm256_setzero_si256());
+}
+
+
+// return which lanes hold a prime digit sum using the prime bitmap
+static inline uint32_t primeLanes(const __m256i sum) {
+    __m256i word = _mm256_i64gather_epi64((const long long *)smallprimeBits, _mm256_srli_epi64(sum, 6), 8);
+    __m256i bit = _mm256_and_si256(_mm256_srlv_epi64(word, _mm256_and_si256(sum, _mm256_set1_epi64x(63))), _mm256_set1_epi64x(1));
+
+    return _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(bit, _mm256_set1_epi64x(1))));
+}
+
+
+// digit sum of each lane for a power of 2 radix given the mask of the lowest bit of each digit
+static inline __m256i powerSum(const __m256i number, const uint64_t ones, const uint32_t bits) {
+    __m256i sum = popcount256(_mm256_and_si256(number, _mm256_set1_epi64x(ones)));
+
+    for (uint32_t i = 1; i < bits; i++) {
+        __m256i count = popcount256(_mm256_and_si256(number, _mm256_set1_epi64x(ones << i)));
+        sum = _mm256_add_epi64(sum, _mm256_slli_epi64(count, i));
+    }
+
+    return sum;
+}
+
+
+// gate the given number of wheel turns from "from" (the start of a turn) keeping values from "low" to "to"
+// on the power of 2 radices up to gates storing the candidates that pass in order and returning how many passed
+// (counting each gate in the funnel given when metrics is true)
+static inline __attribute__((always_inline)) uint32_t gateTurns(uint64_t from, const uint64_t low, const uint64_t to, const uint32_t turns, const uint32_t gates, uint64_t *survivors, const bool metrics, Funnel *funnel) {
+    __m256i number;
+    uint64_t lanes[4];
+    uint32_t range = 0xF;
+    uint32_t pass = 0;
+    uint32_t count = 0;
+    uint32_t k = 0;
+
+    for (uint32_t turn = 0; turn < turns; turn++) {
+        for (uint32_t lane = 0; lane < wheel.count; lane += 4) {
+            number = _mm256_add_epi64(_mm256_set1_epi64x(from), _mm256_loadu_si256((const __m256i *)(wheel.offsets + lane)));
+
+            // the lanes within the range are only needed to count the metrics
+            if (metrics) {
+                _mm256_storeu_si256((__m256i *)lanes, number);
+                range = 0;
+                for (k = 0; k < 4; k++) {
+                    range |= (uint32_t)(lanes[k] >= low && lanes[k] <= to) << k;
+                }
+            }
+METRIC_ADD(checks, _mm_popcnt_u32(range))
+            pass = primeLanes(popcount256(number));
+METRIC_ADD(gate2, _mm_popcnt_u32(pass & range))
+            if (gates >= 4 && pass) pass &= primeLanes(powerSum(number, 0x5555555555555555UL, 2));
+            if (gates >= 4) { METRIC_ADD(gate4, _mm_popcnt_u32(pass & range)) }
+            if (gates >= 8 && pass) pass &= primeLanes(powerSum(number, 0x9249249249249249UL, 3));
+            if (gates >= 8) { METRIC_ADD(gate8, _mm_popcnt_u32(pass & range)) }
+            if (gates >= 16 && pass) pass &= primeLanes(powerSum(number, 0x1111111111111111UL, 4));
+            if (gates >= 16) { METRIC_ADD(gate16, _mm_popcnt_u32(pass & range)) }
+            if (gates >= 32 && pass) pass &= primeLanes(powerSum(number, 0x1084210842108421UL, 5));
+            if (gates >= 32) { METRIC_ADD(gate32, _mm_popcnt_u32(pass & range)) }
+
+            // store the survivors within the range
+            if (pass) {
+                _mm256_storeu_si256((__m256i *)lanes, number);
+                while (pass && lanes[__builtin_ctz(pass)] <= to) {
+                    if (lanes[__builtin_ctz(pass)] >= low) {
+                        survivors[count++] = lanes[__builtin_ctz(pass)];
+                    }
+                    pass &= pass - 1;
+                }
+            }
+        }
+        from += wheel.modulus;
+    }
+
+    return count;
+}
+
+#endif
+
+
+#ifndef VECTOR_DEFAULT
+// gate the given number of wheel turns from "from" (the start of a turn) keeping values from "low" to "to"
+// on the power of 2 radices up to gates using the POPCNT instruction storing the candidates that pass in
+// order and returning how many passed (counting each gate in the funnel given when metrics is true)
+// (only the batch kernel uses it and only where the vector gates are not the default)
+static inline __attribute__((always_inline)) uint32_t gateTurnsScalar(uint64_t from, const uint64_t low, const uint64_t to, const uint32_t turns, const uint32_t gates, uint64_t *survivors, const bool metrics, Funnel *funnel) {
+    uint32_t count = 0;
+
+    for (uint32_t turn = 0; turn < turns; turn++) {
+        for (uint32_t lane = 0; lane < wheel.count; lane++) {
+            uint64_t number = from + wheel.offsets[lane];
+
+            if (number > to) return count;
+            if (number < low) continue;
+METRIC(checks)
+            if (!powerSumIsPrime(number, 0xFFFFFFFFFFFFFFFFUL, 1)) continue;
+METRIC(gate2)
+            if (gates >= 4 && !powerSumIsPrime(number, 0x5555555555555555UL, 2)) continue;
+            if (gates >= 4) { METRIC(gate4) }
+            if (gates >= 8 && !powerSumIsPrime(number, 0x9249249249249249UL, 3)) continue;
+            if (gates >= 8) { METRIC(gate8) }
+            if (gates >= 16 && !powerSumIsPrime(number, 0x1111111111111111UL, 4)) continue;
+            if (gates >= 16) { METRIC(gate16) }
+            if (gates >= 32 && !powerSumIsPrime(number, 0x1084210842108421UL, 5)) continue;
+            if (gates >= 32) { METRIC(gate32) }
+            survivors[count++] = number;
+        }
+        from += wheel.modulus;
+    }
+
+    return count;
+}
+#endif
+
+
+#ifdef VECTOR_KERNEL
+// check primes in the given range for consecutive number base digit sum primes
+// gating a block of candidates on the power of 2 radices with vector instructions and
+// then checking the survivors in order
+static inline __attribute__((always_inline)) uint64_t checkRangeVectorBody(uint64_t from, const uint64_t to, const uint32_t radix, const bool metrics) {
+    Funnel *funnel = gateFunnel(FUNNEL_VECTOR, radix);
+    DigitSumCache cache[51] = {{0}};
+    uint64_t survivors[GATE_CANDIDATES];
+    const uint32_t gates = gateLimit(radix);
+    uint32_t order[51];
+    const uint32_t radices = loadRadixOrder(radix, order);
+    uint64_t turns = 0;
+    uint32_t count = 0;
+
+    // gate whole turns of the wheel skipping any values below the start
+    const uint64_t start = from;
+    from = wheelAlign(from);
+
+    while (from <= to) {
+        // gate the next block of turns (the gates skip values beyond the end of the range)
+        turns = (to - from) / wheel.modulus + 1;
+        if (turns > GATE_CANDIDATES / wheel.count) {
+            turns = GATE_CANDIDATES / wheel.count;
+        }
+        count = gateTurns(from, start, to, turns, gates, survivors, metrics, funnel);
+METRIC_ADD(quick, count)
+
+        // check the survivors in order
+        for (uint32_t i = 0; i < count; i++) {
+            if (checkOrder(survivors[i], order, radices, cache)) {
 METRIC(sums)
-                                    if (isPrime(from)) {
+                if (isPrime(survivors[i])) {
 METRIC(primes)
-                                        return from;
-                                    }
-                                }
-                            }
-                        }
+                    return survivors[i];
+                }
+            }
+        }
+
+        // go to the next block
+        from += turns * wheel.modulus;
+    }
+
+    // not found
+    return to + 1;
+}
+
+
+// checkRangeVector without metrics
+uint64_t checkRangeVector(uint64_t from, const uint64_t to, const uint32_t radix) {
+    return checkRangeVectorBody(from, to, radix, false);
+}
+
+
+// checkRangeVector counting metrics
+uint64_t checkRangeVectorMetrics(uint64_t from, const uint64_t to, const uint32_t radix) {
+    return checkRangeVectorBody(from, to, radix, true);
+}
+#endif
+
+
+// per radix batch statistics (index 0 holds the power of 2 gates)
+static _Atomic uint64_t batchChecks[51];
+static _Atomic uint64_t batchPassed[51];
+static _Atomic uint64_t batchNanos[51];
+
+
+// check primes in the given range for consecutive number base digit sum primes
+// gating a batch of candidates on the power of 2 radices and then sweeping the
+// survivors one radix at a time so each radix lookup table stays in cache
+static inline __attribute__((always_inline)) uint64_t checkRangeBatchBody(uint64_t from, const uint64_t to, const uint32_t radix, const bool metrics) {
+    Funnel *funnel = gateFunnel(FUNNEL_BATCH, radix);
+    DigitSumCache cache[51] = {{0}};
+    uint64_t survivors[GATE_CANDIDATES];
+    uint64_t checks[51] = {0};
+    uint64_t passed[51] = {0};
+    uint64_t nanos[51] = {0};
+    uint32_t order[51];
+    const uint32_t gates = gateLimit(radix);
+    const uint32_t radices = loadRadixOrder(radix, order);
+    uint64_t result = to + 1;
+    uint64_t turns = 0;
+    uint64_t now = 0;
+    uint64_t last = 0;
+    uint32_t count = 0;
+    uint32_t kept = 0;
+    uint32_t i = 0;
+    uint32_t j = 0;
+    uint32_t r = 0;
+
+    // gate whole turns of the wheel skipping any values below the start
+    const uint64_t start = from;
+    from = wheelAlign(from);
+
+    while (from <= to && result > to) {
+        // gate the next batch of turns (the gates skip values beyond the end of the range)
+        turns = (to - from) / wheel.modulus + 1;
+        if (turns > GATE_CANDIDATES / wheel.count) {
+            turns = GATE_CANDIDATES / wheel.count;
+        }
+        last = monotonicNanos();
+#ifdef VECTOR_DEFAULT
+        count = gateTurns(from, start, to, turns, gates, survivors, metrics, funnel);
+#else
+        count = gateTurnsScalar(from, start, to, turns, gates, survivors, metrics, funnel);
+#endif
+        now = monotonicNanos();
+        checks[0] += turns * wheel.count;
+        passed[0] += count;
+        nanos[0] += now - last;
+        last = now;
+METRIC_ADD(quick, count)
+
+        // sweep the survivors radix by radix keeping them in order
+        for (j = 0; j < radices && count > 0; j++) {
+            r = order[j];
+            kept = 0;
+            for (i = 0; i < count; i++) {
+                if (sumDigitsIsPrimeCached(survivors[i], r, &cache[r])) {
+                    survivors[kept++] = survivors[i];
+                }
+            }
+            now = monotonicNanos();
+            checks[r] += count;
+            passed[r] += kept;
+            threadRadixStats.checks[r] += count;
+            threadRadixStats.rejects[r] += count - kept;
+            nanos[r] += now - last;
+            last = now;
+            count = kept;
+        }
+
+        // the first remaining survivor that is prime is the result
+        for (i = 0; i < count; i++) {
+METRIC(sums)
+            if (isPrime(survivors[i])) {
+METRIC(primes)
+                result = survivors[i];
+                break;
+            }
+        }
+
+        // go to the next batch
+        from += turns * wheel.modulus;
+    }
+
+    // add the statistics to the totals
+    for (r = 0; r <= radix; r++) {
+        if (checks[r]) {
+            atomic_fetch_add_explicit(&batchChecks[r], checks[r], memory_order_relaxed);
+            atomic_fetch_add_explicit(&batchPassed[r], passed[r], memory_order_relaxed);
+            atomic_fetch_add_explicit(&batchNanos[r], nanos[r], memory_order_relaxed);
+        }
+    }
+
+    return result;
+}
+
+
+// checkRangeBatch without metrics
+uint64_t checkRangeBatch(uint64_t from, const uint64_t to, const uint32_t radix) {
+    return checkRangeBatchBody(from, to, radix, false);
+}
+
+
+// checkRangeBatch counting metrics
+uint64_t checkRangeBatchMetrics(uint64_t from, const uint64_t to, const uint32_t radix) {
+    return checkRangeBatchBody(from, to, radix, true);
+}
+
+
+// clear the batch statistics (so the kernel calibration is left out of them)
+void resetBatchStats(void) {
+    for (uint32_t r = 0; r <= 50; r++) {
+        atomic_store(&batchChecks[r], 0);
+        atomic_store(&batchPassed[r], 0);
+        atomic_store(&batchNanos[r], 0);
+    }
+}
+
+
+// display the throughput of the power of 2 gates and each radix of the batch kernel
+void displayBatchStats(void) {
+    for (uint32_t r = 0; r <= 50; r++) {
+        uint64_t checked = atomic_load(&batchChecks[r]);
+        uint64_t nanos = atomic_load(&batchNanos[r]);
+
+        if (checked == 0) {
+            continue;
+        }
+        if (r == 0) {
+            printf("Radix gates: ");
+        } else {
+            printf("Radix %2u: ", r);
+        }
+        printf("%'lu checked, %'lu passed, %'.1f million checks/s\n", checked, atomic_load(&batchPassed[r]), nanos ? (double)checked * 1000.0 / nanos : 0.0);
+    }
+}
+
+
+// number of low bits covered by the low bit survivor tables
+// (20 is a multiple of the digit size in radix 2, 4, 16 and 32 so their digit sums split
+// cleanly into the sum of the high bits and the sum of the low bits, radix 8 does not and is
+// checked for each survivor)
+#define LOWBIT_BITS 20
+#define LOWBIT_VALUES (1UL << LOWBIT_BITS)
+#define LOWBIT_WORDS (LOWBIT_VALUES / 64)
+
+// number of power of 2 radices with low bit tables and the largest high bit digit sum of any of them
+#define LOWBIT_RADICES 4
+#define LOWBIT_MAX_SUM 512
+
+
+// low bit survivor tables
+// for each of radix 2, 4, 16 and 32 and each digit sum of the high bits a bitmap of the
+// low bit values whose digit sum added to it is prime, built the first time it is needed
+typedef struct {
+    uint8_t *sums[LOWBIT_RADICES];                          // digit sum of each low bit value
+    Arena arena;                                            // arena holding the digit sums
+    _Atomic(uint64_t *) maps[LOWBIT_RADICES][LOWBIT_MAX_SUM];   // survivor bitmaps by high bit digit sum
+    pthread_mutex_t lock;                                   // lock for building bitmaps
+    _Atomic uint64_t built;                                 // number of bitmaps built
+} LowbitTables;
+
+
+// bits per digit of each radix with low bit tables
+static const uint32_t lowbitDigitBits[LOWBIT_RADICES] = { 1, 2, 4, 5 };
+
+
+// low bit survivor tables used by the low bit kernel
+static LowbitTables lowbit;
+
+
+// return the digit sum of the given value in the power of 2 radix with the given digit size
+static inline uint32_t powerDigitSum(uint64_t value, const uint32_t bits) {
+    const uint64_t mask = (1UL << bits) - 1;
+    uint32_t sum = 0;
+
+    while (value) {
+        sum += value & mask;
+        value >>= bits;
+    }
+
+    return sum;
+}
+
+
+// initialize the low bit digit sums (the bitmaps are built as they are needed)
+void initLowbit(void) {
+    uint8_t *sums = (uint8_t *)allocArena(&lowbit.arena, LOWBIT_RADICES * LOWBIT_VALUES);
+
+    for (uint32_t i = 0; i < LOWBIT_RADICES; i++) {
+        lowbit.sums[i] = sums + i * LOWBIT_VALUES;
+        fillDigitSums(lowbit.sums[i], LOWBIT_VALUES, 1U << lowbitDigitBits[i]);
+    }
+    pthread_mutex_init(&lowbit.lock, NULL);
+    printf("Low bit tables for %u bits\n", LOWBIT_BITS);
+    displayArena(&lowbit.arena, "Low bit digit sums");
+}
+
+
+// free the low bit tables
+void freeLowbit(void) {
+    for (uint32_t i = 0; i < LOWBIT_RADICES; i++) {
+        for (uint32_t sum = 0; sum < LOWBIT_MAX_SUM; sum++) {
+            free(atomic_load(&lowbit.maps[i][sum]));
+            lowbit.maps[i][sum] = NULL;
+        }
+        lowbit.sums[i] = NULL;
+    }
+    freeArena(&lowbit.arena);
+    pthread_mutex_destroy(&lowbit.lock);
+}
+
+
+// return the survivor bitmap for the given radix index and high bit digit sum building it if needed
+static const uint64_t *lowbitMap(const uint32_t index, const uint32_t highSum) {
+    uint64_t *map = atomic_load_explicit(&lowbit.maps[index][highSum], memory_order_acquire);
+    const uint8_t *sums = lowbit.sums[index];
+    uint32_t sum = 0;
+
+    if (map) {
+        return map;
+    }
+
+    // build it unless another thread got there first
+    pthread_mutex_lock(&lowbit.lock);
+    map = atomic_load_explicit(&lowbit.maps[index][highSum], memory_order_acquire);
+    if (!map) {
+        map = (uint64_t *)calloc(LOWBIT_WORDS, sizeof(uint64_t));
+        if (!map) {
+            fprintf(stderr, "Fatal: malloc failed for low bit table\n");
+            exit(EXIT_FAILURE);
+        }
+        for (uint64_t value = 0; value < LOWBIT_VALUES; value++) {
+            sum = highSum + sums[value];
+            map[value >> 6] |= ((smallprimeBits[sum >> 6] >> (sum & 63)) & 1) << (value & 63);
+        }
+        atomic_store_explicit(&lowbit.maps[index][highSum], map, memory_order_release);
+        atomic_fetch_add(&lowbit.built, 1);
+    }
+    pthread_mutex_unlock(&lowbit.lock);
+
+    return map;
+}
+
+
+// return the bits of a word of a run of values that are from first to last (offsets within the run)
+static inline uint64_t runWordMask(const uint32_t word, const uint64_t first, const uint64_t last) {
+    uint64_t mask = ~0UL;
+
+    if (word == first >> 6) {
+        mask &= ~0UL << (first & 63);
+    }
+    if (word == last >> 6 && (last & 63) != 63) {
+        mask &= ~(~0UL << ((last & 63) + 1));
+    }
+
+    return mask;
+}
+
+
+// count each low bit table gate in a funnel for a word of the combined bitmaps
+// (the tables are for radix 2, 4, 16 and 32 in turn)
+static inline void countLowbitGates(Funnel *funnel, const uint64_t **maps, const uint32_t tables, const uint32_t word, uint64_t mask) {
+    uint64_t *gates[LOWBIT_RADICES] = { &funnel->gate2, &funnel->gate4, &funnel->gate16, &funnel->gate32 };
+
+    funnel->checks += _mm_popcnt_u64(mask);
+    for (uint32_t i = 0; i < tables; i++) {
+        mask &= maps[i][word];
+        *gates[i] += _mm_popcnt_u64(mask);
+    }
+}
+
+
+// check primes in the given range for consecutive number base digit sum primes
+// jumping between the values whose radix 2, 4, 16 and 32 digit sums are prime using the
+// low bit survivor tables for the digit sums of the high bits of each run of 2^20 values
+static inline __attribute__((always_inline)) uint64_t checkRangeLowbitBody(uint64_t from, const uint64_t to, const uint32_t radix, const bool metrics) {
+    Funnel *funnel = gateFunnel(FUNNEL_LOWBIT, radix);
+    DigitSumCache cache[51] = {{0}};
+    const uint64_t *maps[LOWBIT_RADICES];
+    const uint32_t gates = gateLimit(radix);
+    uint32_t order[51];
+    const uint32_t radices = loadRadixOrder(radix, order);
+    uint32_t tables = 0;
+    uint64_t high = 0;
+    uint64_t last = 0;
+    uint64_t bits = 0;
+    uint64_t number = 0;
+    uint32_t word = 0;
+    uint32_t endWord = 0;
+    uint32_t i = 0;
+
+    // only use the tables for the power of 2 radices being searched (radix 8 is checked separately)
+    for (i = 0; i < LOWBIT_RADICES; i++) {
+        if ((1U << lowbitDigitBits[i]) <= gates) {
+            tables = i + 1;
+        }
+    }
+
+    while (from <= to) {
+        // find the survivor bitmaps for the high bits of this run
+        high = from >> LOWBIT_BITS;
+        for (i = 0; i < tables; i++) {
+            maps[i] = lowbitMap(i, powerDigitSum(high << LOWBIT_BITS, lowbitDigitBits[i]));
+        }
+
+        // the last value in this run within the range
+        last = (high << LOWBIT_BITS) | (LOWBIT_VALUES - 1);
+        if (last > to) {
+            last = to;
+        }
+        word = (from & (LOWBIT_VALUES - 1)) >> 6;
+        endWord = (last & (LOWBIT_VALUES - 1)) >> 6;
+
+        // combine the bitmaps a word at a time and check each value that survives in order
+        for (; word <= endWord; word++) {
+            if (metrics) {
+                countLowbitGates(funnel, maps, tables, word, runWordMask(word, from & (LOWBIT_VALUES - 1), last & (LOWBIT_VALUES - 1)));
+            }
+            bits = maps[0][word];
+            for (i = 1; i < tables; i++) {
+                bits &= maps[i][word];
+            }
+            while (bits) {
+                number = (high << LOWBIT_BITS) | ((uint64_t)word << 6) | __builtin_ctzll(bits);
+                bits &= bits - 1;
+                if (number < from || number > last) {
+                    continue;
+                }
+
+                // check it is on the wheel and passes radix 8 and then the other radices
+                if (!wheelCandidate(number)) {
+                    continue;
+                }
+METRIC(wheel)
+                if (gates >= 8 && !powerSumIsPrime(number, 0x9249249249249249UL, 3)) {
+                    continue;
+                }
+                if (gates >= 8) { METRIC(gate8) }
+METRIC(quick)
+                if (checkOrder(number, order, radices, cache)) {
+METRIC(sums)
+                    if (isPrime(number)) {
+METRIC(primes)
+                        return number;
+                    }
+                }
+            }
+        }
+
+        // go to the next run
+        if (last == UINT64_MAX) {
+            break;
+        }
+        from = last + 1;
+    }
+
+    // not found
+    return to + 1;
+}
+
+
+// checkRangeLowbit without metrics
+uint64_t checkRangeLowbit(uint64_t from, const uint64_t to, const uint32_t radix) {
+    return checkRangeLowbitBody(from, to, radix, false);
+}
+
+
+// checkRangeLowbit counting metrics
+uint64_t checkRangeLowbitMetrics(uint64_t from, const uint64_t to, const uint32_t radix) {
+    return checkRangeLowbitBody(from, to, radix, true);
+}
+
+
+// sieve bitmap for a run of values (one per search thread so it is only allocated once)
+static _Thread_local uint64_t sieveBits[LOWBIT_WORDS] __attribute__((aligned(64)));
+
+
+// check primes in the given range for consecutive number base digit sum primes
+// sieving each run of 2^20 values: the low bit tables give a bitmap of the values passing
+// radix 2, 4, 16 and 32, then each other radix in turn clears the bits of the values that
+// fail it (the digit sums within a run of radix^4 values come from the lookup table in
+// order so there is only a division when the run changes) and isPrime is only run on the
+// bits left at the end
+static inline __attribute__((always_inline)) uint64_t checkRangeSieveBody(uint64_t from, const uint64_t to, const uint32_t radix, const bool metrics) {
+    Funnel *funnel = gateFunnel(FUNNEL_SIEVE, radix);
+    DigitSumCache cache[51] = {{0}};
+    const uint64_t *maps[LOWBIT_RADICES];
+    uint32_t order[51];
+    const uint32_t gates = gateLimit(radix);
+    const uint32_t radices = loadRadixOrder(radix, order);
+    uint64_t *sieve = sieveBits;
+    uint64_t result = to + 1;
+    uint64_t base = 0;
+    uint64_t last = 0;
+    uint64_t bits = 0;
+    uint64_t fail = 0;
+    uint64_t left = 0;
+    uint64_t number = 0;
+    uint32_t tables = 0;
+    uint32_t first = 0;
+    uint32_t end = 0;
+    uint32_t word = 0;
+    uint32_t bit = 0;
+    uint32_t residue = 0;
+    uint32_t i = 0;
+    uint32_t j = 0;
+
+    // only use the tables for the power of 2 radices being searched (radix 8 is sieved separately)
+    for (i = 0; i < LOWBIT_RADICES; i++) {
+        if ((1U << lowbitDigitBits[i]) <= gates) {
+            tables = i + 1;
+        }
+    }
+
+    while (from <= to && result > to) {
+        // combine the low bit tables for the high bits of this run
+        base = (from >> LOWBIT_BITS) << LOWBIT_BITS;
+        for (i = 0; i < tables; i++) {
+            maps[i] = lowbitMap(i, powerDigitSum(base, lowbitDigitBits[i]));
+        }
+        last = base | (LOWBIT_VALUES - 1);
+        if (last > to) {
+            last = to;
+        }
+        first = (from - base) >> 6;
+        end = (last - base) >> 6;
+        for (word = first; word <= end; word++) {
+            if (metrics) {
+                countLowbitGates(funnel, maps, tables, word, runWordMask(word, from - base, last - base));
+            }
+            sieve[word] = maps[0][word];
+            for (i = 1; i < tables; i++) {
+                sieve[word] &= maps[i][word];
+            }
+        }
+
+        // clear the values outside the range
+        sieve[first] &= ~0UL << ((from - base) & 63);
+        if (((last - base) & 63) != 63) {
+            sieve[end] &= ~(~0UL << (((last - base) & 63) + 1));
+        }
+
+        // sieve the values not on the wheel a word at a time and then those failing radix 8
+        left = 0;
+        number = base + ((uint64_t)first << 6);
+        residue = number - divide(number, &wheel.divider) * wheel.modulus;
+        for (word = first; word <= end; word++) {
+            sieve[word] &= wheelBits(residue);
+            for (residue += 64; residue >= wheel.modulus; residue -= wheel.modulus) {
+            }
+METRIC_ADD(wheel, _mm_popcnt_u64(sieve[word]))
+            bits = gates >= 8 ? sieve[word] : 0;
+            fail = 0;
+            while (bits) {
+                bit = __builtin_ctzll(bits);
+                bits &= bits - 1;
+                if (!powerSumIsPrime(base + ((uint64_t)word << 6) + bit, 0x9249249249249249UL, 3)) {
+                    fail |= 1UL << bit;
+                }
+            }
+            sieve[word] &= ~fail;
+            left |= sieve[word];
+            if (gates >= 8) { METRIC_ADD(gate8, _mm_popcnt_u64(sieve[word])) }
+METRIC_ADD(quick, _mm_popcnt_u64(sieve[word]))
+        }
+
+        // sieve each of the other radices in turn while any values are left
+        for (j = 0; j < radices && left; j++) {
+            left = 0;
+            for (word = first; word <= end; word++) {
+                bits = sieve[word];
+                fail = 0;
+                threadRadixStats.checks[order[j]] += _mm_popcnt_u64(bits);
+                while (bits) {
+                    bit = __builtin_ctzll(bits);
+                    bits &= bits - 1;
+                    if (!sumDigitsIsPrimeCached(base + ((uint64_t)word << 6) + bit, order[j], &cache[order[j]])) {
+                        fail |= 1UL << bit;
                     }
                 }
+                threadRadixStats.rejects[order[j]] += _mm_popcnt_u64(fail);
+                sieve[word] &= ~fail;
+                left |= sieve[word];
+            }
+        }
+
+        // the first value left that is prime is the result
+        for (word = first; word <= end && left && result > to; word++) {
+            bits = sieve[word];
+            while (bits) {
+                number = base + ((uint64_t)word << 6) + __builtin_ctzll(bits);
+                bits &= bits - 1;
+METRIC(sums)
+                if (isPrime(number)) {
+METRIC(primes)
+                    result = number;
+                    break;
+                }
+            }
+        }
+
+        // go to the next run
+        if (last == UINT64_MAX) {
+            break;
+        }
+        from = last + 1;
+    }
+
+    return result;
+}
+
+
+// checkRangeSieve without metrics
+uint64_t checkRangeSieve(uint64_t from, const uint64_t to, const uint32_t radix) {
+    return checkRangeSieveBody(from, to, radix, false);
+}
+
+
+// checkRangeSieve counting metrics
+uint64_t checkRangeSieveMetrics(uint64_t from, const uint64_t to, const uint32_t radix) {
+    return checkRangeSieveBody(from, to, radix, true);
+}
+
+
+// search kernels
+#define KERNEL_SCALAR 0
+#define KERNEL_VECTOR 1
+#define KERNEL_BATCH 2
+#define KERNEL_LOWBIT 3
+#define KERNEL_SIEVE 4
+#define KERNEL_AUTO 5
+
+
+// kernel used when not calibrating (vector if the build machine has AVX-512 VPOPCNTQ, on AVX2 the
+// emulated population count is slower than POPCNT so it must be selected)
+#ifdef VECTOR_DEFAULT
+#define DEFAULT_KERNEL KERNEL_VECTOR
+#else
+#define DEFAULT_KERNEL KERNEL_SCALAR
+#endif
+
+
+// kernel used for searching (auto picks a kernel for each radix by timing them)
+static uint32_t searchKernel = KERNEL_AUTO;
+
+
+// select the search kernel by name returning false if it is unknown or not supported by the build
+bool selectKernel(const char *name) {
+    if (strcmp(name, "scalar") == 0) {
+        searchKernel = KERNEL_SCALAR;
+        return true;
+    }
+
+    if (strcmp(name, "batch") == 0) {
+        searchKernel = KERNEL_BATCH;
+        return true;
+    }
+
+    if (strcmp(name, "lowbit") == 0) {
+        searchKernel = KERNEL_LOWBIT;
+        return true;
+    }
+
+    if (strcmp(name, "sieve") == 0) {
+        searchKernel = KERNEL_SIEVE;
+        return true;
+    }
+
+    if (strcmp(name, "auto") == 0) {
+        searchKernel = KERNEL_AUTO;
+        return true;
+    }
+
+#ifdef VECTOR_KERNEL
+    if (strcmp(name, "vector") == 0) {
+        searchKernel = KERNEL_VECTOR;
+        return true;
+    }
+#endif
+
+    return false;
+}
+
+
+// return the name of the selected search kernel
+const char *kernelName(void) {
+#ifdef VECTOR_KERNEL
+    if (searchKernel == KERNEL_VECTOR) {
+        return "vector (" VECTOR_KERNEL ")";
+    }
+#endif
+#ifdef VECTOR_DEFAULT
+    if (searchKernel == KERNEL_BATCH) {
+        return "batch (" VECTOR_KERNEL " gates)";
+    }
+#else
+    if (searchKernel == KERNEL_BATCH) {
+        return "batch (POPCNT gates)";
+    }
+#endif
+    if (searchKernel == KERNEL_LOWBIT) {
+        return "lowbit";
+    }
+    if (searchKernel == KERNEL_SIEVE) {
+        return "sieve";
+    }
+    if (searchKernel == KERNEL_AUTO) {
+        return "auto";
+    }
+    return "scalar";
+}
+
+
+// check the given range for the given radix using the given kernel
+uint64_t checkRangeWith(const uint32_t kernel, uint64_t from, const uint64_t to, const uint32_t radix) {
+#ifdef VECTOR_KERNEL
+    if (kernel == KERNEL_VECTOR) {
+        return checkRangeVector(from, to, radix);
+    }
+#endif
+    if (kernel == KERNEL_BATCH) {
+        return checkRangeBatch(from, to, radix);
+    }
+    if (kernel == KERNEL_LOWBIT) {
+        return checkRangeLowbit(from, to, radix);
+    }
+    if (kernel == KERNEL_SIEVE) {
+        return checkRangeSieve(from, to, radix);
+    }
+    if (radix < 16) {
+        return checkRangeSub16(from, to, radix);
+    }
+    if (radix < 32) {
+        return checkRange16To31(from, to, radix);
+    }
+    return checkRange32Plus(from, to, radix);
+}
+
+
+// kernel chosen for each radix by the auto kernel
+static uint32_t radixKernel[51];
+
+
+// name of each kernel the auto kernel can choose
+static const char *radixKernelNames[] = { "scalar", "vector", "batch", "lowbit", "sieve" };
+
+
+// number of values each kernel is timed on when calibrating the auto kernel and the smallest
+// range worth calibrating for
+#define CALIBRATE_VALUES (1UL << 20)
+#define CALIBRATE_MIN (1UL << 36)
+
+
+// choose the fastest kernel for each radix by timing each one on the start of the range
+// (each is run twice so the second run has any tables it builds already in place)
+void calibrateKernels(const uint64_t from, const uint64_t to, const uint32_t minradix, const uint32_t maxradix) {
+    const uint32_t kernels[] = { KERNEL_SCALAR, KERNEL_VECTOR, KERNEL_BATCH, KERNEL_LOWBIT, KERNEL_SIEVE };
+    double best = 0.0;
+    double rate = 0.0;
+    uint64_t start = 0;
+    uint64_t found = 0;
+    uint32_t r = 0;
+    uint32_t k = 0;
+    uint32_t i = 0;
+
+    // use the default kernel for every radix if the range is too small to be worth timing
+    for (r = 0; r <= 50; r++) {
+        radixKernel[r] = DEFAULT_KERNEL;
+    }
+    if (to - from < CALIBRATE_MIN) {
+        return;
+    }
+
+    for (r = minradix; r <= maxradix; r++) {
+        best = 0.0;
+        for (k = 0; k < sizeof(kernels) / sizeof(kernels[0]); k++) {
+#ifndef VECTOR_KERNEL
+            if (kernels[k] == KERNEL_VECTOR) {
+                continue;
+            }
+#endif
+            for (i = 0; i < 2; i++) {
+                start = monotonicNanos();
+                found = checkRangeWith(kernels[k], from, from + CALIBRATE_VALUES - 1, r);
+                rate = (double)(found - from) / (monotonicNanos() - start + 1);
+            }
+            if (rate > best) {
+                best = rate;
+                radixKernel[r] = kernels[k];
             }
         }
+    }
 
-        // go to next value
-        from += 2;
+    // display the kernel chosen for each run of radices
+    printf("Radix kernels:");
+    for (r = minradix; r <= maxradix; r = i) {
+        for (i = r + 1; i <= maxradix && radixKernel[i] == radixKernel[r]; i++) {
+        }
+        printf(" %u-%u %s", r, i - 1, radixKernelNames[radixKernel[r]]);
+    }
+    printf("\n");
+}
 
-METRIC(checks)
-        // do a quick check for base 2
-        if (smallprimes[_mm_popcnt_u64(from)]) {
-METRIC(gate2)
-            // do a quick check for base 4
-            digitsum = _mm_popcnt_u64(from & 0x5555555555555555UL);
-            digitsum = _mm_popcnt_u64(from & 0x5555555555555555UL);
-            digitsum += (_mm_popcnt_u64(from & 0xAAAAAAAAAAAAAAAAUL)) << 1;
-            if (smallprimes[digitsum]) {
-METRIC(gate4)
-                // do a quick check for base 8
-                digitsum = _mm_popcnt_u64(from & 0x9249249249249249UL);
-                digitsum += (_mm_popcnt_u64(from & 0x2492492492492492UL)) << 1;
-                digitsum += (_mm_popcnt_u64(from & 0x4924924924924924UL)) << 2;
-                if (smallprimes[digitsum]) {
-METRIC(gate8)
-                    // do a quick check for base 16
-                    digitsum = _mm_popcnt_u64(from & 0x1111111111111111UL);
-                    digitsum += (_mm_popcnt_u64(from & 0x2222222222222222UL)) << 1;
-                    digitsum += (_mm_popcnt_u64(from & 0x4444444444444444UL)) << 2;
-                    digitsum += (_mm_popcnt_u64(from & 0x8888888888888888UL)) << 3;
-                    if (smallprimes[digitsum]) {
-METRIC(gate16)
-                        // do a quick check for base 32
-                        digitsum = _mm_popcnt_u64(from & 0x1084210842108421UL);
-                        digitsum += (_mm_popcnt_u64(from & 0x2108421084210842UL)) << 1;
-                        digitsum += (_mm_popcnt_u64(from & 0x4210842108421084UL)) << 2;
-                        digitsum += (_mm_popcnt_u64(from & 0x8421084210842108UL)) << 3;
-                        digitsum += (_mm_popcnt_u64(from & 0x0842108421084210UL)) << 4;
-                        if (smallprimes[digitsum]) {
-METRIC(gate32)
-                            // check other bases starting at the largest since it will have fewest digits
-                            r = reven;
-                            while (r > 2 && sumDigitsIsPrime(from, r)) {
-                                r -= 2;
-                            }
-                            if (r == 2) { 
-                                r = rodd;
-                                while (r > 1 && sumDigitsIsPrime(from, r)) {
-                                    r -= 2;
-                                }
-                                if (r == 1) { 
-METRIC(sums)
-                                    if (isPrime(from)) {
-METRIC(primes)
-                                        return from;
-                                    }
-                                }
-                            }
-                        }
-                    }
-                }
+
+// return whether the given kernel searched any radix from minRadix to maxRadix
+bool kernelUsed(const uint32_t kernel, const uint32_t minRadix, const uint32_t maxRadix) {
+    if (searchKernel != KERNEL_AUTO) {
+        return searchKernel == kernel;
+    }
+    for (uint32_t r = minRadix; r <= maxRadix; r++) {
+        if (radixKernel[r] == kernel) {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+// check the given range for the given radix using the selected kernel
+// (switching to the copy of the kernel counting metrics when metrics are enabled)
+uint64_t checkRange(uint64_t from, const uint64_t to, const uint32_t radix) {
+    const uint32_t kernel = searchKernel == KERNEL_AUTO ? radixKernel[radix] : searchKernel;
+
+    if (!metricsEnabled) {
+        return checkRangeWith(kernel, from, to, radix);
+    }
+#ifdef VECTOR_KERNEL
+    if (kernel == KERNEL_VECTOR) {
+        return checkRangeVectorMetrics(from, to, radix);
+    }
+#endif
+    if (kernel == KERNEL_BATCH) {
+        return checkRangeBatchMetrics(from, to, radix);
+    }
+    if (kernel == KERNEL_LOWBIT) {
+        return checkRangeLowbitMetrics(from, to, radix);
+    }
+    if (kernel == KERNEL_SIEVE) {
+        return checkRangeSieveMetrics(from, to, radix);
+    }
+    if (radix < 16) {
+        return checkRangeSub16Metrics(from, to, radix);
+    }
+    if (radix < 32) {
+        return checkRange16To31Metrics(from, to, radix);
+    }
+    return checkRange32PlusMetrics(from, to, radix);
+}
+
+
+// maximum number of search threads
+#define MAX_THREADS 256
+
+// number of values in each work chunk
+#define CHUNK_SIZE (30UL << 20)
+
+
+// queue of chunks owned by a search thread
+// the owner takes chunks from the head and idle threads steal them from the tail
+typedef struct {
+    pthread_mutex_t lock;
+    uint64_t head;
+    uint64_t tail;
+    _Atomic uint64_t active;    // chunk the owner is searching (UINT64_MAX if none)
+} ChunkQueue;
+
+
+// search state shared by all search threads
+typedef struct {
+    uint64_t base;          // first value of chunk 0
+    uint64_t end;           // last value to search
+    uint64_t chunks;        // number of chunks
+    uint32_t minradix;      // first radix to search for
+    uint32_t maxradix;      // last radix to search for
+    uint32_t threads;       // number of search threads
+    ChunkQueue *queues;     // one chunk queue per thread
+} SearchState;
+
+
+// arguments for each search thread
+typedef struct {
+    SearchState *state;
+    uint32_t id;
+} SearchThread;
+
+
+// smallest value found so far for each radix (UINT64_MAX if none)
+static _Atomic uint64_t radixBest[51];
+
+
+// time spent and values covered searching at each radix level (summed over the threads)
+static _Atomic uint64_t levelNanos[51];
+static _Atomic uint64_t levelValues[51];
+
+
+// seconds between periodic checkpoints
+#define CHECKPOINT_SECONDS 60
+
+
+// checkpoint file version (bump if the format changes)
+#define CHECKPOINT_VERSION 2
+
+
+// search progress saved to the checkpoint file
+typedef struct {
+    const char *path;           // checkpoint file (NULL if not checkpointing)
+    uint64_t start;             // searched range and bases (a checkpoint is only resumed for the same search)
+    uint64_t end;
+    uint32_t minradix;
+    uint32_t maxradix;
+    uint64_t resume;            // every value below this has been searched
+    uint64_t elapsed;           // nanoseconds spent searching before this run
+    uint64_t started;           // monotonic time this run started searching
+    uint64_t written;           // monotonic time of the last checkpoint
+    uint64_t best[51];          // smallest value found for each radix when resumed (UINT64_MAX if none)
+    pthread_mutex_t lock;       // lock for writing the checkpoint
+} Checkpoint;
+
+
+// checkpoint state
+static Checkpoint checkpoint = { .lock = PTHREAD_MUTEX_INITIALIZER };
+
+
+// set by SIGINT or SIGTERM to stop the search after the chunks in progress
+static volatile sig_atomic_t stopSearch = 0;
+
+
+// signal handler that stops the search so a checkpoint can be written
+static void requestStop(int32_t signal) {
+    (void)signal;
+    stopSearch = 1;
+}
+
+
+// board file version (bump if the layout changes)
+#define BOARD_MAGIC 0x44524f4241425344UL
+#define BOARD_VERSION 1
+
+
+// board shared between search processes through a mapped file
+// each search posts the smallest value it finds for each radix and checks the board between radix
+// levels of each chunk, so a chunk above a value found by any search skips that radix while the
+// searches below it carry on to prove the smallest value
+typedef struct {
+    uint64_t magic;             // BOARD_MAGIC
+    uint64_t version;           // BOARD_VERSION
+    _Atomic uint64_t best[51];  // smallest value posted for each radix (0 if none)
+} Board;
+
+
+// shared board (NULL if not sharing)
+static Board *board = NULL;
+
+
+// map the board file creating it if needed
+void openBoard(const char *path) {
+    struct stat status;
+    int32_t fd;
+
+    if ((fd = open(path, O_RDWR | O_CREAT, 0644)) < 0 || fstat(fd, &status) != 0 ||
+        ((uint64_t)status.st_size < sizeof(Board) && ftruncate(fd, sizeof(Board)) != 0)) {
+        fprintf(stderr, "Fatal: cannot open board %s\n", path);
+        exit(EXIT_FAILURE);
+    }
+    board = (Board *)mmap(NULL, sizeof(Board), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (board == MAP_FAILED) {
+        fprintf(stderr, "Fatal: cannot map board %s\n", path);
+        exit(EXIT_FAILURE);
+    }
+
+    // a new board is all zero so claim it, any other layout is a fatal error
+    uint64_t magic = 0;
+    atomic_compare_exchange_strong((_Atomic uint64_t *)&board->magic, &magic, BOARD_MAGIC);
+    if (board->magic != BOARD_MAGIC || (board->version != 0 && board->version != BOARD_VERSION)) {
+        fprintf(stderr, "Fatal: %s is not a board for this version\n", path);
+        exit(EXIT_FAILURE);
+    }
+    board->version = BOARD_VERSION;
+}
+
+
+// return whether any search has posted a value below the given value for the given radix
+static inline bool solvedBelow(const uint32_t radix, const uint64_t value) {
+    uint64_t posted;
+
+    if (!board) {
+        return false;
+    }
+    posted = atomic_load_explicit(&board->best[radix], memory_order_relaxed);
+    return posted != 0 && posted < value;
+}
+
+
+// post a value found for the given radix to the board keeping the smallest
+void postBoard(const uint32_t radix, const uint64_t value) {
+    uint64_t current;
+
+    if (board) {
+        current = atomic_load(&board->best[radix]);
+        while ((current == 0 || value < current) && !atomic_compare_exchange_weak(&board->best[radix], &current, value)) {
+        }
+    }
+}
+
+
+// record a value found for the given radix keeping the smallest (and post it to the board)
+void recordBest(const uint32_t radix, const uint64_t value) {
+    uint64_t current = atomic_load(&radixBest[radix]);
+
+    while (value < current && !atomic_compare_exchange_weak(&radixBest[radix], &current, value)) {
+    }
+    postBoard(radix, value);
+}
+
+
+// seconds between writes of the status metrics file
+#define STATUS_SECONDS 2
+
+
+// status page version (bump if the layout changes)
+#define STATUS_MAGIC 0x5355544154535344UL
+#define STATUS_VERSION 1
+
+
+// progress of a search thread on the status page (one cache line each so threads never share one)
+typedef struct {
+    _Atomic uint64_t from;      // value the current radix level is searching from
+    _Atomic uint64_t radix;     // radix being searched
+    _Atomic uint64_t searched;  // values searched in completed chunks
+    _Atomic uint64_t hits;      // values found
+    _Atomic uint64_t rate;      // values per second over the last chunk
+    _Atomic uint64_t updated;   // unix time of the last update in nanoseconds
+} __attribute__((aligned(64))) StatusSlot;
+
+
+// status page of a search in a mapped file
+// each thread only ever writes its own slot with atomic stores so dashboards can read it at any time
+typedef struct {
+    _Atomic uint64_t magic;     // STATUS_MAGIC (set last once the page is filled in)
+    uint64_t version;           // STATUS_VERSION
+    uint64_t pid;               // process searching
+    uint64_t start;             // range searched
+    uint64_t end;
+    uint64_t resume;            // first value searched by this run (after any checkpoint)
+    uint64_t minradix;          // radices searched
+    uint64_t maxradix;
+    uint64_t threads;           // number of thread slots
+    uint64_t started;           // unix time the search started in nanoseconds
+    _Atomic uint64_t done;      // set when the search completes
+    StatusSlot slot[];          // one slot per search thread
+} StatusPage;
+
+
+// status of the search (NULL if not publishing one)
+static struct {
+    const char *path;           // status page file (the metrics file is the same name with .prom added)
+    StatusPage *page;
+    uint64_t size;              // size of the page in bytes
+    uint64_t written;           // monotonic time of the last metrics file
+    pthread_mutex_t lock;       // lock for writing the metrics file
+} status = { .lock = PTHREAD_MUTEX_INITIALIZER };
+
+
+// status slot of the current search thread
+static _Thread_local StatusSlot *threadStatus = NULL;
+
+
+// get unix time in nanoseconds
+uint64_t unixNanos(void) {
+    struct timespec now;
+
+    clock_gettime(CLOCK_REALTIME, &now);
+    return (uint64_t)now.tv_sec * 1000000000UL + now.tv_nsec;
+}
+
+
+// create the status page file for the given search and map it
+void openStatus(const char *path, const uint64_t start, const uint64_t end, const uint64_t resume,
+                const uint32_t minradix, const uint32_t maxradix, const uint32_t threads) {
+    int32_t fd;
+
+    status.path = path;
+    status.size = sizeof(StatusPage) + threads * sizeof(StatusSlot);
+    if ((fd = open(path, O_RDWR | O_CREAT, 0644)) < 0 || ftruncate(fd, status.size) != 0) {
+        fprintf(stderr, "Fatal: cannot create status page %s\n", path);
+        exit(EXIT_FAILURE);
+    }
+    status.page = (StatusPage *)mmap(NULL, status.size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (status.page == MAP_FAILED) {
+        fprintf(stderr, "Fatal: cannot map status page %s\n", path);
+        exit(EXIT_FAILURE);
+    }
+
+    // fill in the page before marking it valid
+    atomic_store(&status.page->magic, 0);
+    memset((uint8_t *)status.page + sizeof(uint64_t), 0, status.size - sizeof(uint64_t));
+    status.page->version = STATUS_VERSION;
+    status.page->pid = getpid();
+    status.page->start = start;
+    status.page->end = end;
+    status.page->resume = resume;
+    status.page->minradix = minradix;
+    status.page->maxradix = maxradix;
+    status.page->threads = threads;
+    status.page->started = unixNanos();
+    for (uint32_t i = 0; i < threads; i++) {
+        atomic_store_explicit(&status.page->slot[i].from, resume, memory_order_relaxed);
+        atomic_store_explicit(&status.page->slot[i].radix, minradix, memory_order_relaxed);
+        atomic_store_explicit(&status.page->slot[i].updated, status.page->started, memory_order_relaxed);
+    }
+    atomic_store(&status.page->magic, STATUS_MAGIC);
+    status.written = monotonicNanos();
+}
+
+
+// publish the value and radix the current thread is searching
+static inline void publishPosition(const uint64_t from, const uint32_t radix) {
+    if (threadStatus) {
+        atomic_store_explicit(&threadStatus->from, from, memory_order_relaxed);
+        atomic_store_explicit(&threadStatus->radix, radix, memory_order_relaxed);
+        atomic_store_explicit(&threadStatus->updated, unixNanos(), memory_order_relaxed);
+    }
+}
+
+
+// publish a chunk of the given number of values completed by the current thread in the given time
+// with the number of values it found
+static inline void publishChunk(const uint64_t values, const uint64_t nanos, const uint32_t hits) {
+    if (threadStatus) {
+        atomic_fetch_add_explicit(&threadStatus->searched, values, memory_order_relaxed);
+        atomic_fetch_add_explicit(&threadStatus->hits, hits, memory_order_relaxed);
+        atomic_store_explicit(&threadStatus->rate, values * 1000000000UL / (nanos + 1), memory_order_relaxed);
+        atomic_store_explicit(&threadStatus->updated, unixNanos(), memory_order_relaxed);
+    }
+}
+
+
+// write one metric for each thread to the metrics file
+static void writeStatusMetric(FILE *file, const char *labels, const char *name, const char *help, const size_t offset, const double scale) {
+    const StatusPage *page = status.page;
+
+    fprintf(file, "# HELP %s %s\n# TYPE %s gauge\n", name, help, name);
+    for (uint32_t i = 0; i < page->threads; i++) {
+        const _Atomic uint64_t *field = (const _Atomic uint64_t *)((const uint8_t *)&page->slot[i] + offset);
+
+        fprintf(file, "%s{%s,thread=\"%u\"} %.17g\n", name, labels, i, atomic_load_explicit(field, memory_order_relaxed) * scale);
+    }
+}
+
+
+// write the status page as a Prometheus text metrics file (to a temporary file renamed into place)
+void writeStatusMetrics(void) {
+    StatusPage *page = status.page;
+    char path[PATH_MAX];
+    char temp[PATH_MAX + 4];
+    char labels[128];
+    uint64_t searched = 0;
+    uint64_t hits = 0;
+    uint64_t rate = 0;
+    uint64_t remaining = 0;
+    FILE *file;
+
+    // totals over the threads
+    for (uint32_t i = 0; i < page->threads; i++) {
+        searched += atomic_load_explicit(&page->slot[i].searched, memory_order_relaxed);
+        hits += atomic_load_explicit(&page->slot[i].hits, memory_order_relaxed);
+        rate += atomic_load_explicit(&page->slot[i].rate, memory_order_relaxed);
+    }
+    remaining = page->end - page->resume + 1 > searched ? page->end - page->resume + 1 - searched : 0;
+
+    snprintf(path, sizeof(path), "%s.prom", status.path);
+    snprintf(temp, sizeof(temp), "%s.tmp", path);
+    snprintf(labels, sizeof(labels), "start=\"%lu\",end=\"%lu\"", page->start, page->end);
+    if (!(file = fopen(temp, "w"))) {
+        fprintf(stderr, "Fatal: cannot create status metrics file %s\n", temp);
+        exit(EXIT_FAILURE);
+    }
+    writeStatusMetric(file, labels, "ds_position", "Value each search thread is searching from", offsetof(StatusSlot, from), 1.0);
+    writeStatusMetric(file, labels, "ds_radix", "Radix each search thread is searching", offsetof(StatusSlot, radix), 1.0);
+    writeStatusMetric(file, labels, "ds_values_per_second", "Values searched per second by each thread over its last chunk", offsetof(StatusSlot, rate), 1.0);
+    writeStatusMetric(file, labels, "ds_last_update_seconds", "Unix time each thread last reported progress", offsetof(StatusSlot, updated), 1e-9);
+    fprintf(file, "# HELP ds_searched_values_total Values searched by this run\n# TYPE ds_searched_values_total counter\n");
+    fprintf(file, "ds_searched_values_total{%s} %lu\n", labels, searched);
+    fprintf(file, "# HELP ds_hits_total Values found by this run\n# TYPE ds_hits_total counter\n");
+    fprintf(file, "ds_hits_total{%s} %lu\n", labels, hits);
+    fprintf(file, "# HELP ds_eta_seconds Estimated seconds until the search completes\n# TYPE ds_eta_seconds gauge\n");
+    fprintf(file, "ds_eta_seconds{%s} %.1f\n", labels, rate ? (double)remaining / rate : 0.0);
+    fprintf(file, "# HELP ds_done Whether the search has completed\n# TYPE ds_done gauge\n");
+    fprintf(file, "ds_done{%s} %lu\n", labels, atomic_load(&page->done));
+    if (ferror(file) || fclose(file) != 0 || rename(temp, path) != 0) {
+        fprintf(stderr, "Fatal: cannot write status metrics file %s\n", path);
+        exit(EXIT_FAILURE);
+    }
+    status.written = monotonicNanos();
+}
+
+
+// write the status metrics file if one is due (only one thread writes it)
+void periodicStatus(void) {
+    if (monotonicNanos() - status.written < STATUS_SECONDS * 1000000000UL || pthread_mutex_trylock(&status.lock) != 0) {
+        return;
+    }
+    if (monotonicNanos() - status.written >= STATUS_SECONDS * 1000000000UL) {
+        writeStatusMetrics();
+    }
+    pthread_mutex_unlock(&status.lock);
+}
+
+
+// mark the search complete (or stopped) on the status page and write the final metrics file
+void closeStatus(const bool done) {
+    atomic_store(&status.page->done, done);
+    writeStatusMetrics();
+    munmap(status.page, status.size);
+    status.page = NULL;
+}
+
+
+// get the next chunk for the given thread, stealing from the busiest thread if its own queue is empty
+// returns false when there is no work left
+bool takeChunk(SearchState *state, const uint32_t id, uint64_t *chunk) {
+    ChunkQueue *own = &state->queues[id];
+    ChunkQueue *queue = own;
+    uint64_t remaining = 0;
+    uint64_t most = 0;
+    uint32_t victim = 0;
+
+    // stop taking work if asked to
+    if (stopSearch) {
+        atomic_store(&own->active, UINT64_MAX);
+        return false;
+    }
+
+    // take the lowest chunk from our own queue
+    pthread_mutex_lock(&queue->lock);
+    if (queue->head < queue->tail) {
+        *chunk = queue->head * state->threads + id;
+        queue->head++;
+        atomic_store(&own->active, *chunk);
+        pthread_mutex_unlock(&queue->lock);
+        return true;
+    }
+    pthread_mutex_unlock(&queue->lock);
+
+    // steal the highest chunk from the thread with the most work left
+    do {
+        most = 0;
+        for (uint32_t i = 0; i < state->threads; i++) {
+            queue = &state->queues[i];
+            pthread_mutex_lock(&queue->lock);
+            remaining = queue->tail - queue->head;
+            pthread_mutex_unlock(&queue->lock);
+            if (remaining > most) {
+                most = remaining;
+                victim = i;
+            }
+        }
+
+        // check if there was anything to steal
+        if (most) {
+            queue = &state->queues[victim];
+            pthread_mutex_lock(&queue->lock);
+            if (queue->head < queue->tail) {
+                queue->tail--;
+                *chunk = queue->tail * state->threads + victim;
+                atomic_store(&own->active, *chunk);
+                pthread_mutex_unlock(&queue->lock);
+                return true;
             }
+            pthread_mutex_unlock(&queue->lock);
+        }
+    } while (most);
+
+    // no work left
+    atomic_store(&own->active, UINT64_MAX);
+    return false;
+}
+
+
+// return the lowest value not yet searched (every chunk below it has been searched)
+// (a chunk is always either in a queue or active so all the queues are locked to see a consistent view)
+uint64_t searchedTo(SearchState *state) {
+    uint64_t lowest = state->chunks;
+    uint64_t active;
+    uint32_t i;
+
+    for (i = 0; i < state->threads; i++) {
+        pthread_mutex_lock(&state->queues[i].lock);
+    }
+    for (i = 0; i < state->threads; i++) {
+        if (state->queues[i].head < state->queues[i].tail && state->queues[i].head * state->threads + i < lowest) {
+            lowest = state->queues[i].head * state->threads + i;
+        }
+        active = atomic_load(&state->queues[i].active);
+        if (active < lowest) {
+            lowest = active;
+        }
+    }
+    for (i = state->threads; i > 0; i--) {
+        pthread_mutex_unlock(&state->queues[i - 1].lock);
+    }
+
+    return lowest == state->chunks ? state->end + 1 : state->base + lowest * CHUNK_SIZE;
+}
+
+
+// write the checkpoint file for the search progress so far
+// (written to a temporary file and renamed so an interruption never leaves a partial one)
+void writeCheckpoint(const uint64_t resume) {
+    char temp[PATH_MAX];
+    uint32_t radix = 0;
+    FILE *file;
+
+    // write the progress and the values found so far
+    snprintf(temp, sizeof(temp), "%s.tmp", checkpoint.path);
+    if (!(file = fopen(temp, "w"))) {
+        fprintf(stderr, "Fatal: cannot create checkpoint file %s\n", temp);
+        exit(EXIT_FAILURE);
+    }
+    fprintf(file, "ds checkpoint %u\n", CHECKPOINT_VERSION);
+    fprintf(file, "range %lu %lu\n", checkpoint.start, checkpoint.end);
+    fprintf(file, "bases %u %u\n", checkpoint.minradix, checkpoint.maxradix);
+    fprintf(file, "resume %lu\n", resume);
+    fprintf(file, "elapsed %lu\n", checkpoint.elapsed + monotonicNanos() - checkpoint.started);
+    for (radix = 2; radix <= 50; radix++) {
+        if (atomic_load(&radixBest[radix]) != UINT64_MAX) {
+            fprintf(file, "best %u %lu\n", radix, atomic_load(&radixBest[radix]));
         }
+    }
+    fflush(file);
+    fsync(fileno(file));
+    if (ferror(file) || fclose(file) != 0 || rename(temp, checkpoint.path) != 0) {
+        fprintf(stderr, "Fatal: cannot write checkpoint file %s\n", checkpoint.path);
+        exit(EXIT_FAILURE);
+    }
+    checkpoint.written = monotonicNanos();
+}
 
-        // go to next value
-        from += 4;
 
-METRIC(checks)
-        // do a quick check for base 2
-        if (smallprimes[_mm_popcnt_u64(from)]) {
-METRIC(gate2)
-            // do a quick check for base 4
-            digitsum = _mm_popcnt_u64(from & 0x5555555555555555UL);
-            digitsum = _mm_popcnt_u64(from & 0x5555555555555555UL);
-            digitsum += (_mm_popcnt_u64(from & 0xAAAAAAAAAAAAAAAAUL)) << 1;
-            if (smallprimes[digitsum]) {
-METRIC(gate4)
-                // do a quick check for base 8
-                digitsum = _mm_popcnt_u64(from & 0x9249249249249249UL);
-                digitsum += (_mm_popcnt_u64(from & 0x2492492492492492UL)) << 1;
-                digitsum += (_mm_popcnt_u64(from & 0x4924924924924924UL)) << 2;
-                if (smallprimes[digitsum]) {
-METRIC(gate8)
-                    // do a quick check for base 16
-                    digitsum = _mm_popcnt_u64(from & 0x1111111111111111UL);
-                    digitsum += (_mm_popcnt_u64(from & 0x2222222222222222UL)) << 1;
-                    digitsum += (_mm_popcnt_u64(from & 0x4444444444444444UL)) << 2;
-                    digitsum += (_mm_popcnt_u64(from & 0x8888888888888888UL)) << 3;
-                    if (smallprimes[digitsum]) {
-METRIC(gate16)
-                        // do a quick check for base 32
-                        digitsum = _mm_popcnt_u64(from & 0x1084210842108421UL);
-                        digitsum += (_mm_popcnt_u64(from & 0x2108421084210842UL)) << 1;
-                        digitsum += (_mm_popcnt_u64(from & 0x4210842108421084UL)) << 2;
-                        digitsum += (_mm_popcnt_u64(from & 0x8421084210842108UL)) << 3;
-                        digitsum += (_mm_popcnt_u64(from & 0x0842108421084210UL)) << 4;
-                        if (smallprimes[digitsum]) {
-METRIC(gate32)
-                            // check other bases starting at the largest since it will have fewest digits
-                            r = reven;
-                            while (r > 2 && sumDigitsIsPrime(from, r)) {
-                                r -= 2;
-                            }
-                            if (r == 2) { 
-                                r = rodd;
-                                while (r > 1 && sumDigitsIsPrime(from, r)) {
-                                    r -= 2;
-                                }
-                                if (r == 1) { 
-METRIC(sums)
-                                    if (isPrime(from)) {
-METRIC(primes)
-                                        return from;
-                                    }
-                                }
-                            }
-                        }
-                    }
-                }
-            }
+// read the checkpoint file if there is one for the given range and bases
+// returns false if there is no checkpoint to resume from
+bool readCheckpoint(void) {
+    uint64_t start = 0, end = 0, value = 0;
+    uint32_t version = 0, radix = 0, minradix = 0, maxradix = 0;
+    char line[128];
+    FILE *file;
+
+    // no values found yet
+    for (radix = 0; radix <= 50; radix++) {
+        checkpoint.best[radix] = UINT64_MAX;
+    }
+    if (!(file = fopen(checkpoint.path, "r"))) {
+        return false;
+    }
+
+    // check the checkpoint is for this range and bases (values found for other bases would be wrong)
+    if (fscanf(file, "ds checkpoint %u\n", &version) != 1 || version != CHECKPOINT_VERSION ||
+        fscanf(file, "range %lu %lu\n", &start, &end) != 2 || start != checkpoint.start || end != checkpoint.end ||
+        fscanf(file, "bases %u %u\n", &minradix, &maxradix) != 2 || minradix != checkpoint.minradix || maxradix != checkpoint.maxradix) {
+        fclose(file);
+        printf("Ignoring checkpoint %s for a different search\n", checkpoint.path);
+        return false;
+    }
+
+    // read the progress and the values found so far
+    while (fgets(line, sizeof(line), file)) {
+        if (sscanf(line, "resume %lu", &value) == 1) {
+            checkpoint.resume = value;
+        } else if (sscanf(line, "elapsed %lu", &value) == 1) {
+            checkpoint.elapsed = value;
+        } else if (sscanf(line, "best %u %lu", &radix, &value) == 2 && radix <= 50) {
+            checkpoint.best[radix] = value;
         }
+    }
+    fclose(file);
 
-        // go to next value
-        from += 2;
+    return true;
+}
 
-METRIC(checks)
-        // do a quick check for base 2
-        if (smallprimes[_mm_popcnt_u64(from)]) {
-METRIC(gate2)
-            // do a quick check for base 4
-            digitsum = _mm_popcnt_u64(from & 0x5555555555555555UL);
-            digitsum = _mm_popcnt_u64(from & 0x5555555555555555UL);
-            digitsum += (_mm_popcnt_u64(from & 0xAAAAAAAAAAAAAAAAUL)) << 1;
-            if (smallprimes[digitsum]) {
-METRIC(gate4)
-                // do a quick check for base 8
-                digitsum = _mm_popcnt_u64(from & 0x9249249249249249UL);
-                digitsum += (_mm_popcnt_u64(from & 0x2492492492492492UL)) << 1;
-                digitsum += (_mm_popcnt_u64(from & 0x4924924924924924UL)) << 2;
-                if (smallprimes[digitsum]) {
-METRIC(gate8)
-                    // do a quick check for base 16
-                    digitsum = _mm_popcnt_u64(from & 0x1111111111111111UL);
-                    digitsum += (_mm_popcnt_u64(from & 0x2222222222222222UL)) << 1;
-                    digitsum += (_mm_popcnt_u64(from & 0x4444444444444444UL)) << 2;
-                    digitsum += (_mm_popcnt_u64(from & 0x8888888888888888UL)) << 3;
-                    if (smallprimes[digitsum]) {
-METRIC(gate16)
-                        // do a quick check for base 32
-                        digitsum = _mm_popcnt_u64(from & 0x1084210842108421UL);
-                        digitsum += (_mm_popcnt_u64(from & 0x2108421084210842UL)) << 1;
-                        digitsum += (_mm_popcnt_u64(from & 0x4210842108421084UL)) << 2;
-                        digitsum += (_mm_popcnt_u64(from & 0x8421084210842108UL)) << 3;
-                        digitsum += (_mm_popcnt_u64(from & 0x0842108421084210UL)) << 4;
-                        if (smallprimes[digitsum]) {
-METRIC(gate32)
-                            // check other bases starting at the largest since it will have fewest digits
-                            r = reven;
-                            while (r > 2 && sumDigitsIsPrime(from, r)) {
-                                r -= 2;
-                            }
-                            if (r == 2) { 
-                                r = rodd;
-                                while (r > 1 && sumDigitsIsPrime(from, r)) {
-                                    r -= 2;
-                                }
-                                if (r == 1) { 
-METRIC(sums)
-                                    if (isPrime(from)) {
-METRIC(primes)
-                                        return from;
-                                    }
-                                }
-                            }
-                        }
-                    }
-                }
-            }
+
+// write a periodic checkpoint if one is due (only one thread writes it)
+void periodicCheckpoint(SearchState *state) {
+    if (monotonicNanos() - checkpoint.written < CHECKPOINT_SECONDS * 1000000000UL || pthread_mutex_trylock(&checkpoint.lock) != 0) {
+        return;
+    }
+    if (monotonicNanos() - checkpoint.written >= CHECKPOINT_SECONDS * 1000000000UL) {
+        writeCheckpoint(searchedTo(state));
+    }
+    pthread_mutex_unlock(&checkpoint.lock);
+}
+
+
+// search a single chunk starting at the lowest radix not already found below the chunk
+void searchChunk(SearchState *state, const uint64_t chunk) {
+    uint64_t from = state->base + chunk * CHUNK_SIZE;
+    uint64_t to = (chunk == state->chunks - 1) ? state->end : from + CHUNK_SIZE - 1;
+    const uint64_t chunkStart = monotonicNanos();
+    const uint64_t values = to - from + 1;
+    uint64_t found = 0;
+    uint64_t started = 0;
+    uint32_t radix = state->minradix;
+    uint32_t hits = 0;
+
+    // skip any radix already found below this chunk by this or any other search since it cannot improve on it
+    while (radix <= state->maxradix && (atomic_load(&radixBest[radix]) < from || solvedBelow(radix, from))) {
+        radix++;
+    }
+
+    // check each radix in turn continuing from the last value found
+    while (radix <= state->maxradix) {
+        publishPosition(from, radix);
+        started = monotonicNanos();
+        found = checkRange(from, to, radix);
+        atomic_fetch_add(&levelNanos[radix], monotonicNanos() - started);
+        atomic_fetch_add(&levelValues[radix], (found > to || found < from ? to : found) - from + 1);
+        if (found > to || found < from) {
+            break;
         }
+        recordBest(radix, found);
+        hits++;
 
-        // go to next value
-        from += 4;
+        // the value found also reaches each further radix whose digit sum is prime
+        while (radix < state->maxradix && smallprimes[sumDigits(found, radix + 1)]) {
+            radix++;
+            recordBest(radix, found);
+            hits++;
+        }
 
-METRIC(checks)
-        // do a quick check for base 2
-        if (smallprimes[_mm_popcnt_u64(from)]) {
-METRIC(gate2)
-            // do a quick check for base 4
-            digitsum = _mm_popcnt_u64(from & 0x5555555555555555UL);
-            digitsum = _mm_popcnt_u64(from & 0x5555555555555555UL);
-            digitsum += (_mm_popcnt_u64(from & 0xAAAAAAAAAAAAAAAAUL)) << 1;
-            if (smallprimes[digitsum]) {
-METRIC(gate4)
-                // do a quick check for base 8
-                digitsum = _mm_popcnt_u64(from & 0x9249249249249249UL);
-                digitsum += (_mm_popcnt_u64(from & 0x2492492492492492UL)) << 1;
-                digitsum += (_mm_popcnt_u64(from & 0x4924924924924924UL)) << 2;
-                if (smallprimes[digitsum]) {
-METRIC(gate8)
-                    // do a quick check for base 16
-                    digitsum = _mm_popcnt_u64(from & 0x1111111111111111UL);
-                    digitsum += (_mm_popcnt_u64(from & 0x2222222222222222UL)) << 1;
-                    digitsum += (_mm_popcnt_u64(from & 0x4444444444444444UL)) << 2;
-                    digitsum += (_mm_popcnt_u64(from & 0x8888888888888888UL)) << 3;
-                    if (smallprimes[digitsum]) {
-METRIC(gate16)
-                        // do a quick check for base 32
-                        digitsum = _mm_popcnt_u64(from & 0x1084210842108421UL);
-                        digitsum += (_mm_popcnt_u64(from & 0x2108421084210842UL)) << 1;
-                        digitsum += (_mm_popcnt_u64(from & 0x4210842108421084UL)) << 2;
-                        digitsum += (_mm_popcnt_u64(from & 0x8421084210842108UL)) << 3;
-                        digitsum += (_mm_popcnt_u64(from & 0x0842108421084210UL)) << 4;
-                        if (smallprimes[digitsum]) {
-METRIC(gate32)
-                            // check other bases starting at the largest since it will have fewest digits
-                            r = reven;
-                            while (r > 2 && sumDigitsIsPrime(from, r)) {
-                                r -= 2;
-                            }
-                            if (r == 2) { 
-                                r = rodd;
-                                while (r > 1 && sumDigitsIsPrime(from, r)) {
-                                    r -= 2;
-                                }
-                                if (r == 1) { 
-METRIC(sums)
-                                    if (isPrime(from)) {
-METRIC(primes)
-                                        return from;
-                                    }
-                                }
-                            }
-                        }
-                    }
-                }
-            }
+        // continue from the value found skipping any radix another search has found below it
+        from = found;
+        radix++;
+        while (radix <= state->maxradix && solvedBelow(radix, from)) {
+            radix++;
         }
+    }
 
-        // go to next value
-        from += 6;
+    // add this chunk's radix statistics to the adaptive order and its metrics to the totals
+    updateRadixOrder(state->maxradix);
+    if (metricsEnabled) {
+        updateMetrics();
+    }
 
-METRIC(checks)
-        // do a quick check for base 2
-        if (smallprimes[_mm_popcnt_u64(from)]) {
-METRIC(gate2)
-            // do a quick check for base 4
-            digitsum = _mm_popcnt_u64(from & 0x5555555555555555UL);
-            digitsum = _mm_popcnt_u64(from & 0x5555555555555555UL);
-            digitsum += (_mm_popcnt_u64(from & 0xAAAAAAAAAAAAAAAAUL)) << 1;
-            if (smallprimes[digitsum]) {
-METRIC(gate4)
-                // do a quick check for base 8
-                digitsum = _mm_popcnt_u64(from & 0x9249249249249249UL);
-                digitsum += (_mm_popcnt_u64(from & 0x2492492492492492UL)) << 1;
-                digitsum += (_mm_popcnt_u64(from & 0x4924924924924924UL)) << 2;
-                if (smallprimes[digitsum]) {
-METRIC(gate8)
-                    // do a quick check for base 16
-                    digitsum = _mm_popcnt_u64(from & 0x1111111111111111UL);
-                    digitsum += (_mm_popcnt_u64(from & 0x2222222222222222UL)) << 1;
-                    digitsum += (_mm_popcnt_u64(from & 0x4444444444444444UL)) << 2;
-                    digitsum += (_mm_popcnt_u64(from & 0x8888888888888888UL)) << 3;
-                    if (smallprimes[digitsum]) {
-METRIC(gate16)
-                        // do a quick check for base 32
-                        digitsum = _mm_popcnt_u64(from & 0x1084210842108421UL);
-                        digitsum += (_mm_popcnt_u64(from & 0x2108421084210842UL)) << 1;
-                        digitsum += (_mm_popcnt_u64(from & 0x4210842108421084UL)) << 2;
-                        digitsum += (_mm_popcnt_u64(from & 0x8421084210842108UL)) << 3;
-                        digitsum += (_mm_popcnt_u64(from & 0x0842108421084210UL)) << 4;
-                        if (smallprimes[digitsum]) {
-METRIC(gate32)
-                            // check other bases starting at the largest since it will have fewest digits
-                            r = reven;
-                            while (r > 2 && sumDigitsIsPrime(from, r)) {
-                                r -= 2;
-                            }
-                            if (r == 2) { 
-                                r = rodd;
-                                while (r > 1 && sumDigitsIsPrime(from, r)) {
-                                    r -= 2;
-                                }
-                                if (r == 1) { 
-METRIC(sums)
-                                    if (isPrime(from)) {
-METRIC(primes)
-                                        return from;
-                                    }
-                                }
-                            }
-                        }
-                    }
-                }
-            }
+    // publish the completed chunk to the status page
+    publishChunk(values, monotonicNanos() - chunkStart, hits);
+}
+
+
+// logical CPU each search thread is pinned to (NULL if the threads are not pinned)
+// threads beyond the number of CPUs wrap around to the first
+static int32_t *threadCpus = NULL;
+static uint32_t threadCpuCount = 0;
+
+
+// pin the calling thread to the given logical CPU
+void pinThread(const int32_t cpu) {
+    cpu_set_t set;
+
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+}
+
+
+// search thread entry point
+void *searchThread(void *arg) {
+    SearchThread *thread = (SearchThread *)arg;
+    uint64_t chunk = 0;
+
+    // run on the CPU chosen for this thread if the threads are pinned
+    if (threadCpus) {
+        pinThread(threadCpus[thread->id % threadCpuCount]);
+    }
+
+    // publish progress to this thread's slot on the status page
+    if (status.page) {
+        threadStatus = &status.page->slot[thread->id];
+    }
+
+    while (takeChunk(thread->state, thread->id, &chunk)) {
+        searchChunk(thread->state, chunk);
+        if (checkpoint.path) {
+            periodicCheckpoint(thread->state);
+        }
+        if (status.page) {
+            periodicStatus();
         }
+    }
 
-        // go to next value
-        from += 2;
+    return NULL;
+}
 
-METRIC(checks)
-        // do a quick check for base 2
-        if (smallprimes[_mm_popcnt_u64(from)]) {
-METRIC(gate2)
-            // do a quick check for base 4
-            digitsum = _mm_popcnt_u64(from & 0x5555555555555555UL);
-            digitsum = _mm_popcnt_u64(from & 0x5555555555555555UL);
-            digitsum += (_mm_popcnt_u64(from & 0xAAAAAAAAAAAAAAAAUL)) << 1;
-            if (smallprimes[digitsum]) {
-METRIC(gate4)
-                // do a quick check for base 8
-                digitsum = _mm_popcnt_u64(from & 0x9249249249249249UL);
-                digitsum += (_mm_popcnt_u64(from & 0x2492492492492492UL)) << 1;
-                digitsum += (_mm_popcnt_u64(from & 0x4924924924924924UL)) << 2;
-                if (smallprimes[digitsum]) {
-METRIC(gate8)
-                    // do a quick check for base 16
-                    digitsum = _mm_popcnt_u64(from & 0x1111111111111111UL);
-                    digitsum += (_mm_popcnt_u64(from & 0x2222222222222222UL)) << 1;
-                    digitsum += (_mm_popcnt_u64(from & 0x4444444444444444UL)) << 2;
-                    digitsum += (_mm_popcnt_u64(from & 0x8888888888888888UL)) << 3;
-                    if (smallprimes[digitsum]) {
-METRIC(gate16)
-                        // do a quick check for base 32
-                        digitsum = _mm_popcnt_u64(from & 0x1084210842108421UL);
-                        digitsum += (_mm_popcnt_u64(from & 0x2108421084210842UL)) << 1;
-                        digitsum += (_mm_popcnt_u64(from & 0x4210842108421084UL)) << 2;
-                        digitsum += (_mm_popcnt_u64(from & 0x8421084210842108UL)) << 3;
-                        digitsum += (_mm_popcnt_u64(from & 0x0842108421084210UL)) << 4;
-                        if (smallprimes[digitsum]) {
-METRIC(gate32)
-                            // check other bases starting at the largest since it will have fewest digits
-                            r = reven;
-                            while (r > 2 && sumDigitsIsPrime(from, r)) {
-                                r -= 2;
-                            }
-                            if (r == 2) { 
-                                r = rodd;
-                                while (r > 1 && sumDigitsIsPrime(from, r)) {
-                                    r -= 2;
-                                }
-                                if (r == 1) { 
-METRIC(sums)
-                                    if (isPrime(from)) {
-METRIC(primes)
-                                        return from;
-                                    }
-                                }
-                            }
-                        }
-                    }
-                }
-            }
+
+// search the given range for each radix from minradix to maxradix using multiple threads
+// each radix gets the smallest value found which is the same value a sequential search would find
+// returns the lowest value not searched (end + 1 unless the search was stopped by a signal)
+uint64_t searchRange(const uint64_t from, const uint64_t to, const uint32_t minradix, const uint32_t maxradix, const uint32_t threads) {
+    SearchState state;
+    SearchThread *args = NULL;
+    pthread_t *handles = NULL;
+    uint64_t perThread = 0;
+    uint64_t searched = 0;
+    uint32_t i = 0;
+
+    // start from the values found before any checkpoint
+    for (i = 0; i < sizeof(radixBest) / sizeof(radixBest[0]); i++) {
+        atomic_store(&radixBest[i], checkpoint.path ? checkpoint.best[i] : UINT64_MAX);
+    }
+
+    // check there is something to search
+    if (from > to || minradix > maxradix) {
+        return to + 1;
+    }
+
+    // split the range into chunks interleaved across the threads so they all start near the bottom
+    state.base = from;
+    state.end = to;
+    state.chunks = (to - from) / CHUNK_SIZE + 1;
+    state.minradix = minradix;
+    state.maxradix = maxradix;
+    state.threads = threads;
+    state.queues = (ChunkQueue *)calloc(threads, sizeof(ChunkQueue));
+    args = (SearchThread *)calloc(threads, sizeof(SearchThread));
+    handles = (pthread_t *)calloc(threads, sizeof(pthread_t));
+    if (!state.queues || !args || !handles) {
+        fprintf(stderr, "Fatal: malloc failed for search threads\n");
+        exit(EXIT_FAILURE);
+    }
+
+    perThread = state.chunks / threads;
+    for (i = 0; i < threads; i++) {
+        pthread_mutex_init(&state.queues[i].lock, NULL);
+        state.queues[i].head = 0;
+        state.queues[i].tail = perThread + (i < state.chunks % threads ? 1 : 0);
+        state.queues[i].active = UINT64_MAX;
+    }
+
+    // start the search threads (the main thread acts as the first one)
+    for (i = 0; i < threads; i++) {
+        args[i].state = &state;
+        args[i].id = i;
+        if (i > 0 && pthread_create(&handles[i], NULL, searchThread, &args[i]) != 0) {
+            fprintf(stderr, "Fatal: failed to create search thread\n");
+            exit(EXIT_FAILURE);
         }
+    }
+    searchThread(&args[0]);
 
-        // go to next value
-        from += 6;
+    // wait for the search threads to complete
+    for (i = 1; i < threads; i++) {
+        pthread_join(handles[i], NULL);
     }
+    searched = searchedTo(&state);
 
-    // not found
-    return to + 1;
-}
+    // free the search state
+    for (i = 0; i < threads; i++) {
+        pthread_mutex_destroy(&state.queues[i].lock);
+    }
+    free(handles);
+    free(args);
+    free(state.queues);
 
+    return searched;
+}
 
-// check primes in the given range for consecutive number base digit sum primes
-// Note: requires "from" value to be in the form 30k+7
-//       works for radix values >= 16 and < 31
-uint64_t checkRange16To31(uint64_t from, const uint64_t to, const uint32_t radix) {
-    uint32_t digitsum = 0;
-    uint32_t r = 0;
 
-    while (from <= to) {
-METRIC(checks)
-METRIC(plus16)
-        // do a quick check for base 2
-        if (smallprimes[_mm_popcnt_u64(from)]) {
-METRIC(gate2)
-            // do a quick check for base 4
-            digitsum = _mm_popcnt_u64(from & 0x5555555555555555UL);
-            digitsum += (_mm_popcnt_u64(from & 0xAAAAAAAAAAAAAAAAUL)) << 1;
-            if (smallprimes[digitsum]) {
-METRIC(gate4)
-                // do a quick check for base 8
-                digitsum = _mm_popcnt_u64(from & 0x9249249249249249UL);
-                digitsum += (_mm_popcnt_u64(from & 0x2492492492492492UL)) << 1;
-                digitsum += (_mm_popcnt_u64(from & 0x4924924924924924UL)) << 2;
-                if (smallprimes[digitsum]) {
-METRIC(gate8)
-                    // do a quick check for base 16
-                    digitsum = _mm_popcnt_u64(from & 0x1111111111111111UL);
-                    digitsum += (_mm_popcnt_u64(from & 0x2222222222222222UL)) << 1;
-                    digitsum += (_mm_popcnt_u64(from & 0x4444444444444444UL)) << 2;
-                    digitsum += (_mm_popcnt_u64(from & 0x8888888888888888UL)) << 3;
-                    if (smallprimes[digitsum]) {
-                        // check other bases starting at the largest since it will have fewest digits
-                        r = radix;
-                        while (r > 2 && sumDigitsIsPrime(from, r)) {
-                            r--;
-                        }
-                        if (r == 2) { 
-METRIC(sums)
-                            if (isPrime(from)) {
-METRIC(primes)
-                                return from;
-                            }
-                        }
-                    }
-                }
-            }
+// write a string to a JSON file escaping any characters that need it
+static void writeJsonString(FILE *file, const char *text) {
+    fputc('"', file);
+    for (; *text; text++) {
+        if (*text == '"' || *text == '\\') {
+            fputc('\\', file);
+        }
+        if ((uint8_t)*text >= ' ') {
+            fputc(*text, file);
         }
+    }
+    fputc('"', file);
+}
 
-        // go to next value
-        from += 4;
 
-METRIC(checks)
-        // do a quick check for base 2
-        if (smallprimes[_mm_popcnt_u64(from)]) {
-METRIC(gate2)
-            // do a quick check for base 4
-            digitsum = _mm_popcnt_u64(from & 0x5555555555555555UL);
-            digitsum = _mm_popcnt_u64(from & 0x5555555555555555UL);
-            digitsum += (_mm_popcnt_u64(from & 0xAAAAAAAAAAAAAAAAUL)) << 1;
-            if (smallprimes[digitsum]) {
-METRIC(gate4)
-                // do a quick check for base 8
-                digitsum = _mm_popcnt_u64(from & 0x9249249249249249UL);
-                digitsum += (_mm_popcnt_u64(from & 0x2492492492492492UL)) << 1;
-                digitsum += (_mm_popcnt_u64(from & 0x4924924924924924UL)) << 2;
-                if (smallprimes[digitsum]) {
-METRIC(gate8)
-                    // do a quick check for base 16
-                    digitsum = _mm_popcnt_u64(from & 0x1111111111111111UL);
-                    digitsum += (_mm_popcnt_u64(from & 0x2222222222222222UL)) << 1;
-                    digitsum += (_mm_popcnt_u64(from & 0x4444444444444444UL)) << 2;
-                    digitsum += (_mm_popcnt_u64(from & 0x8888888888888888UL)) << 3;
-                    if (smallprimes[digitsum]) {
-                        // check other bases starting at the largest since it will have fewest digits
-                        r = radix;
-                        while (r > 2 && sumDigitsIsPrime(from, r)) {
-                            r--;
-                        }
-                        if (r == 2) { 
-METRIC(sums)
-                            if (isPrime(from)) {
-METRIC(primes)
-                                return from;
-                            }
-                        }
-                    }
-                }
+// read the CPU model name (empty if unknown)
+static void cpuModel(char *model, const size_t size) {
+    char line[256];
+    char *value;
+    FILE *cpuinfo;
+
+    model[0] = '\0';
+    if ((cpuinfo = fopen("/proc/cpuinfo", "r"))) {
+        while (fgets(line, sizeof(line), cpuinfo)) {
+            if (strncmp(line, "model name", 10) == 0 && (value = strchr(line, ':'))) {
+                value += strspn(value, ": \t");
+                value[strcspn(value, "\n")] = '\0';
+                snprintf(model, size, "%s", value);
+                break;
             }
         }
+        fclose(cpuinfo);
+    }
+}
 
-        // go to next value
-        from += 2;
 
-METRIC(checks)
-        // do a quick check for base 2
-        if (smallprimes[_mm_popcnt_u64(from)]) {
-METRIC(gate2)
-            // do a quick check for base 4
-            digitsum = _mm_popcnt_u64(from & 0x5555555555555555UL);
-            digitsum = _mm_popcnt_u64(from & 0x5555555555555555UL);
-            digitsum += (_mm_popcnt_u64(from & 0xAAAAAAAAAAAAAAAAUL)) << 1;
-            if (smallprimes[digitsum]) {
-METRIC(gate4)
-                // do a quick check for base 8
-                digitsum = _mm_popcnt_u64(from & 0x9249249249249249UL);
-                digitsum += (_mm_popcnt_u64(from & 0x2492492492492492UL)) << 1;
-                digitsum += (_mm_popcnt_u64(from & 0x4924924924924924UL)) << 2;
-                if (smallprimes[digitsum]) {
-METRIC(gate8)
-                    // do a quick check for base 16
-                    digitsum = _mm_popcnt_u64(from & 0x1111111111111111UL);
-                    digitsum += (_mm_popcnt_u64(from & 0x2222222222222222UL)) << 1;
-                    digitsum += (_mm_popcnt_u64(from & 0x4444444444444444UL)) << 2;
-                    digitsum += (_mm_popcnt_u64(from & 0x8888888888888888UL)) << 3;
-                    if (smallprimes[digitsum]) {
-                        // check other bases starting at the largest since it will have fewest digits
-                        r = radix;
-                        while (r > 2 && sumDigitsIsPrime(from, r)) {
-                            r--;
-                        }
-                        if (r == 2) { 
-METRIC(sums)
-                            if (isPrime(from)) {
-METRIC(primes)
-                                return from;
-                            }
-                        }
-                    }
-                }
-            }
-        }
+// report file version (bump if fields change meaning or are removed)
+#define REPORT_VERSION 1
 
-        // go to next value
-        from += 4;
 
-METRIC(checks)
-        // do a quick check for base 2
-        if (smallprimes[_mm_popcnt_u64(from)]) {
-METRIC(gate2)
-            // do a quick check for base 4
-            digitsum = _mm_popcnt_u64(from & 0x5555555555555555UL);
-            digitsum = _mm_popcnt_u64(from & 0x5555555555555555UL);
-            digitsum += (_mm_popcnt_u64(from & 0xAAAAAAAAAAAAAAAAUL)) << 1;
-            if (smallprimes[digitsum]) {
-METRIC(gate4)
-                // do a quick check for base 8
-                digitsum = _mm_popcnt_u64(from & 0x9249249249249249UL);
-                digitsum += (_mm_popcnt_u64(from & 0x2492492492492492UL)) << 1;
-                digitsum += (_mm_popcnt_u64(from & 0x4924924924924924UL)) << 2;
-                if (smallprimes[digitsum]) {
-METRIC(gate8)
-                    // do a quick check for base 16
-                    digitsum = _mm_popcnt_u64(from & 0x1111111111111111UL);
-                    digitsum += (_mm_popcnt_u64(from & 0x2222222222222222UL)) << 1;
-                    digitsum += (_mm_popcnt_u64(from & 0x4444444444444444UL)) << 2;
-                    digitsum += (_mm_popcnt_u64(from & 0x8888888888888888UL)) << 3;
-                    if (smallprimes[digitsum]) {
-                        // check other bases starting at the largest since it will have fewest digits
-                        r = radix;
-                        while (r > 2 && sumDigitsIsPrime(from, r)) {
-                            r--;
-                        }
-                        if (r == 2) { 
-METRIC(sums)
-                            if (isPrime(from)) {
-METRIC(primes)
-                                return from;
-                            }
-                        }
-                    }
-                }
-            }
-        }
+// write a JSON report of the completed search
+// (written to a temporary file and renamed so readers never see a partial one)
+void writeReport(const char *path, const uint64_t start, const uint64_t end, const uint32_t minradix, const uint32_t maxradix,
+                 const uint32_t threads, const uint64_t nanos) {
+    char temp[PATH_MAX];
+    char model[256];
+    const char *separator = "";
+    uint32_t r;
+    FILE *file;
 
-        // go to next value
-        from += 2;
+    snprintf(temp, sizeof(temp), "%s.tmp", path);
+    if (!(file = fopen(temp, "w"))) {
+        fprintf(stderr, "Fatal: cannot create report file %s\n", temp);
+        exit(EXIT_FAILURE);
+    }
 
-METRIC(checks)
-        // do a quick check for base 2
-        if (smallprimes[_mm_popcnt_u64(from)]) {
-METRIC(gate2)
-            // do a quick check for base 4
-            digitsum = _mm_popcnt_u64(from & 0x5555555555555555UL);
-            digitsum = _mm_popcnt_u64(from & 0x5555555555555555UL);
-            digitsum += (_mm_popcnt_u64(from & 0xAAAAAAAAAAAAAAAAUL)) << 1;
-            if (smallprimes[digitsum]) {
-METRIC(gate4)
-                // do a quick check for base 8
-                digitsum = _mm_popcnt_u64(from & 0x9249249249249249UL);
-                digitsum += (_mm_popcnt_u64(from & 0x2492492492492492UL)) << 1;
-                digitsum += (_mm_popcnt_u64(from & 0x4924924924924924UL)) << 2;
-                if (smallprimes[digitsum]) {
-METRIC(gate8)
-                    // do a quick check for base 16
-                    digitsum = _mm_popcnt_u64(from & 0x1111111111111111UL);
-                    digitsum += (_mm_popcnt_u64(from & 0x2222222222222222UL)) << 1;
-                    digitsum += (_mm_popcnt_u64(from & 0x4444444444444444UL)) << 2;
-                    digitsum += (_mm_popcnt_u64(from & 0x8888888888888888UL)) << 3;
-                    if (smallprimes[digitsum]) {
-                        // check other bases starting at the largest since it will have fewest digits
-                        r = radix;
-                        while (r > 2 && sumDigitsIsPrime(from, r)) {
-                            r--;
-                        }
-                        if (r == 2) { 
-METRIC(sums)
-                            if (isPrime(from)) {
-METRIC(primes)
-                                return from;
-                            }
-                        }
-                    }
-                }
-            }
+    // search parameters
+    cpuModel(model, sizeof(model));
+    fprintf(file, "{\n  \"version\": %u,\n  \"start\": %lu,\n  \"end\": %lu,\n", REPORT_VERSION, start, end);
+    fprintf(file, "  \"minbase\": %u,\n  \"maxbase\": %u,\n  \"threads\": %u,\n", minradix, maxradix, threads);
+    fprintf(file, "  \"kernel\": ");
+    writeJsonString(file, kernelName());
+    fprintf(file, ",\n  \"cpu\": ");
+    writeJsonString(file, model);
+
+    // time and table memory
+    fprintf(file, ",\n  \"seconds\": %.6f,\n", (double)nanos / 1000000000);
+    fprintf(file, "  \"table_bytes\": { \"digit_sums\": %lu, \"low_bit\": %lu },\n", digitSumBytes,
+            lowbit.sums[0] ? LOWBIT_RADICES * LOWBIT_VALUES + atomic_load(&lowbit.built) * LOWBIT_WORDS * sizeof(uint64_t) : 0);
+
+    // smallest value found for each radix
+    fprintf(file, "  \"hits\": [");
+    for (r = minradix; r <= maxradix; r++) {
+        if (resultValues[r] == 0) {
+            continue;
+        }
+        fprintf(file, "%s\n    { \"n\": %u, \"value\": %lu }", separator, r - 1, resultValues[r]);
+        separator = ",";
+    }
+    fprintf(file, "%s],\n", *separator ? "\n  " : "");
+
+    // time and values searched at each radix level and the candidates checked and rejected in each radix
+    // (the power of 2 radices are checked by the gates so have no count)
+    separator = "";
+    fprintf(file, "  \"levels\": [");
+    for (r = minradix; r <= maxradix; r++) {
+        if (atomic_load(&levelValues[r]) == 0) {
+            continue;
         }
+        fprintf(file, "%s\n    { \"base\": %u, \"kernel\": \"%s\", \"thread_seconds\": %.6f, \"values\": %lu, \"checks\": %lu, \"rejects\": %lu }",
+                separator, r, searchKernel == KERNEL_AUTO ? radixKernelNames[radixKernel[r]] : radixKernelNames[searchKernel],
+                (double)atomic_load(&levelNanos[r]) / 1000000000, atomic_load(&levelValues[r]),
+                atomic_load(&radixOrder.checks[r]) - metricTotals.checks[r], atomic_load(&radixOrder.rejects[r]) - metricTotals.rejects[r]);
+        separator = ",";
+    }
+    fprintf(file, "%s]\n}\n", *separator ? "\n  " : "");
 
-        // go to next value
-        from += 4;
+    if (ferror(file) || fclose(file) != 0 || rename(temp, path) != 0) {
+        fprintf(stderr, "Fatal: cannot write report file %s\n", path);
+        exit(EXIT_FAILURE);
+    }
+}
 
-METRIC(checks)
-        // do a quick check for base 2
-        if (smallprimes[_mm_popcnt_u64(from)]) {
-METRIC(gate2)
-            // do a quick check for base 4
-            digitsum = _mm_popcnt_u64(from & 0x5555555555555555UL);
-            digitsum = _mm_popcnt_u64(from & 0x5555555555555555UL);
-            digitsum += (_mm_popcnt_u64(from & 0xAAAAAAAAAAAAAAAAUL)) << 1;
-            if (smallprimes[digitsum]) {
-METRIC(gate4)
-                // do a quick check for base 8
-                digitsum = _mm_popcnt_u64(from & 0x9249249249249249UL);
-                digitsum += (_mm_popcnt_u64(from & 0x2492492492492492UL)) << 1;
-                digitsum += (_mm_popcnt_u64(from & 0x4924924924924924UL)) << 2;
-                if (smallprimes[digitsum]) {
-METRIC(gate8)
-                    // do a quick check for base 16
-                    digitsum = _mm_popcnt_u64(from & 0x1111111111111111UL);
-                    digitsum += (_mm_popcnt_u64(from & 0x2222222222222222UL)) << 1;
-                    digitsum += (_mm_popcnt_u64(from & 0x4444444444444444UL)) << 2;
-                    digitsum += (_mm_popcnt_u64(from & 0x8888888888888888UL)) << 3;
-                    if (smallprimes[digitsum]) {
-                        // check other bases starting at the largest since it will have fewest digits
-                        r = radix;
-                        while (r > 2 && sumDigitsIsPrime(from, r)) {
-                            r--;
-                        }
-                        if (r == 2) { 
-METRIC(sums)
-                            if (isPrime(from)) {
-METRIC(primes)
-                                return from;
-                            }
-                        }
-                    }
-                }
-            }
-        }
 
-        // go to next value
-        from += 6;
+// ledger of completed searches shared by every search writing to the same results directory
+// each completed search appends one line holding its range, bases, time and the values found
+// ending with a CRC so a line torn by a crash is ignored, and a summary of the merged ranges
+// and the smallest value for each radix is kept beside it so queries only read the lines
+// appended since the summary was written
+#define LEDGER_VERSION 1
 
-METRIC(checks)
-        // do a quick check for base 2
-        if (smallprimes[_mm_popcnt_u64(from)]) {
-METRIC(gate2)
-            // do a quick check for base 4
-            digitsum = _mm_popcnt_u64(from & 0x5555555555555555UL);
-            digitsum = _mm_popcnt_u64(from & 0x5555555555555555UL);
-            digitsum += (_mm_popcnt_u64(from & 0xAAAAAAAAAAAAAAAAUL)) << 1;
-            if (smallprimes[digitsum]) {
-METRIC(gate4)
-                // do a quick check for base 8
-                digitsum = _mm_popcnt_u64(from & 0x9249249249249249UL);
-                digitsum += (_mm_popcnt_u64(from & 0x2492492492492492UL)) << 1;
-                digitsum += (_mm_popcnt_u64(from & 0x4924924924924924UL)) << 2;
-                if (smallprimes[digitsum]) {
-METRIC(gate8)
-                    // do a quick check for base 16
-                    digitsum = _mm_popcnt_u64(from & 0x1111111111111111UL);
-                    digitsum += (_mm_popcnt_u64(from & 0x2222222222222222UL)) << 1;
-                    digitsum += (_mm_popcnt_u64(from & 0x4444444444444444UL)) << 2;
-                    digitsum += (_mm_popcnt_u64(from & 0x8888888888888888UL)) << 3;
-                    if (smallprimes[digitsum]) {
-                        // check other bases starting at the largest since it will have fewest digits
-                        r = radix;
-                        while (r > 2 && sumDigitsIsPrime(from, r)) {
-                            r--;
-                        }
-                        if (r == 2) { 
-METRIC(sums)
-                            if (isPrime(from)) {
-METRIC(primes)
-                                return from;
-                            }
-                        }
-                    }
-                }
-            }
+
+// range of values covered by completed searches
+typedef struct {
+    uint64_t start;
+    uint64_t end;
+} LedgerRange;
+
+
+// summary of the ledger
+typedef struct {
+    uint64_t covers;        // bytes of the ledger included in the summary
+    LedgerRange *ranges;    // merged ranges in order
+    uint32_t count;         // number of ranges
+    uint32_t size;          // number of ranges allocated
+    uint64_t best[51];      // smallest value found for each radix (0 if none)
+} LedgerSummary;
+
+
+// return the CRC32C of the given text
+static uint32_t ledgerCrc(const char *text, const size_t length) {
+    uint32_t crc = ~0U;
+
+    for (size_t i = 0; i < length; i++) {
+        crc = _mm_crc32_u8(crc, text[i]);
+    }
+    return ~crc;
+}
+
+
+// add a range to the summary merging it with any ranges it overlaps or touches
+static void addLedgerRange(LedgerSummary *summary, const uint64_t start, const uint64_t end) {
+    uint32_t low = 0, high = summary->count, last;
+
+    // find the first range that ends at or after the value before the start
+    while (low < high) {
+        uint32_t middle = (low + high) / 2;
+        if (start > 0 && summary->ranges[middle].end < start - 1) {
+            low = middle + 1;
+        } else {
+            high = middle;
         }
+    }
 
-        // go to next value
-        from += 2;
+    // merge with the ranges it overlaps or touches
+    if (low < summary->count && (summary->ranges[low].start == 0 || summary->ranges[low].start - 1 <= end)) {
+        for (last = low; last + 1 < summary->count && summary->ranges[last + 1].start - 1 <= end; last++) {
+        }
+        if (start < summary->ranges[low].start) {
+            summary->ranges[low].start = start;
+        }
+        summary->ranges[low].end = end > summary->ranges[last].end ? end : summary->ranges[last].end;
+        memmove(&summary->ranges[low + 1], &summary->ranges[last + 1], (summary->count - last - 1) * sizeof(LedgerRange));
+        summary->count -= last - low;
+        return;
+    }
 
-METRIC(checks)
-        // do a quick check for base 2
-        if (smallprimes[_mm_popcnt_u64(from)]) {
-METRIC(gate2)
-            // do a quick check for base 4
-            digitsum = _mm_popcnt_u64(from & 0x5555555555555555UL);
-            digitsum = _mm_popcnt_u64(from & 0x5555555555555555UL);
-            digitsum += (_mm_popcnt_u64(from & 0xAAAAAAAAAAAAAAAAUL)) << 1;
-            if (smallprimes[digitsum]) {
-METRIC(gate4)
-                // do a quick check for base 8
-                digitsum = _mm_popcnt_u64(from & 0x9249249249249249UL);
-                digitsum += (_mm_popcnt_u64(from & 0x2492492492492492UL)) << 1;
-                digitsum += (_mm_popcnt_u64(from & 0x4924924924924924UL)) << 2;
-                if (smallprimes[digitsum]) {
-METRIC(gate8)
-                    // do a quick check for base 16
-                    digitsum = _mm_popcnt_u64(from & 0x1111111111111111UL);
-                    digitsum += (_mm_popcnt_u64(from & 0x2222222222222222UL)) << 1;
-                    digitsum += (_mm_popcnt_u64(from & 0x4444444444444444UL)) << 2;
-                    digitsum += (_mm_popcnt_u64(from & 0x8888888888888888UL)) << 3;
-                    if (smallprimes[digitsum]) {
-                        // check other bases starting at the largest since it will have fewest digits
-                        r = radix;
-                        while (r > 2 && sumDigitsIsPrime(from, r)) {
-                            r--;
-                        }
-                        if (r == 2) { 
-METRIC(sums)
-                            if (isPrime(from)) {
-METRIC(primes)
-                                return from;
-                            }
-                        }
-                    }
-                }
-            }
+    // otherwise insert it
+    if (summary->count == summary->size) {
+        summary->size = summary->size ? summary->size * 2 : 64;
+        if (!(summary->ranges = (LedgerRange *)realloc(summary->ranges, summary->size * sizeof(LedgerRange)))) {
+            fprintf(stderr, "Fatal: malloc failed for ledger ranges\n");
+            exit(EXIT_FAILURE);
         }
+    }
+    memmove(&summary->ranges[low + 1], &summary->ranges[low], (summary->count - low) * sizeof(LedgerRange));
+    summary->ranges[low].start = start;
+    summary->ranges[low].end = end;
+    summary->count++;
+}
+
 
-        // go to next value
-        from += 6;
+// add a ledger line to the summary returning false if it is torn or corrupt
+static bool addLedgerLine(LedgerSummary *summary, const char *line) {
+    const char *check = strrchr(line, '#');
+    uint64_t start, end, value;
+    uint32_t crc, radix;
+    int32_t used = 0;
+
+    // check the CRC of everything before it
+    if (!check || sscanf(check, "#%8x", &crc) != 1 || crc != ledgerCrc(line, check - line)) {
+        return false;
+    }
+    if (sscanf(line, "D %lu %lu %*u %*u %*u%n", &start, &end, &used) != 2 || used == 0) {
+        return false;
     }
 
-    // not found
-    return to + 1;
+    // add the range and the values found
+    addLedgerRange(summary, start, end);
+    for (line += used; sscanf(line, " %u:%lu%n", &radix, &value, &used) == 2; line += used) {
+        if (radix <= 50 && (summary->best[radix] == 0 || value < summary->best[radix])) {
+            summary->best[radix] = value;
+        }
+    }
+    return true;
 }
 
 
-// check primes in the given range for consecutive number base digit sum primes
-// Note: requires "from" value to be in the form 30k+7
-//       works for radix values < 16
-uint64_t checkRangeSub16(uint64_t from, const uint64_t to, const uint32_t radix) {
-    bool allprime = false;
+// add the complete lines appended to the ledger after the part already in the summary
+// returns whether any were added
+static bool readLedgerLines(const char *path, LedgerSummary *summary) {
+    char line[4096];
+    bool added = false;
+    FILE *file;
 
-    while (from <= to) {
-METRIC(checks)
-METRIC(sub16)
-        // do a quick check for base 2
-        uint32_t digitsum = _mm_popcnt_u64(from);
-        allprime = smallprimes[digitsum];
-        if (allprime && radix >= 4) {
-METRIC(gate2)
-            // do a quick check for base 4
-            digitsum = _mm_popcnt_u64(from & 0x5555555555555555UL);
-            digitsum += (_mm_popcnt_u64(from & 0xAAAAAAAAAAAAAAAAUL)) << 1;
-            allprime = smallprimes[digitsum];
-            if (allprime && radix >= 8) {
-METRIC(gate4)
-                // do a quick check for base 8
-                digitsum = _mm_popcnt_u64(from & 0x9249249249249249UL);
-                digitsum += (_mm_popcnt_u64(from & 0x2492492492492492UL)) << 1;
-                digitsum += (_mm_popcnt_u64(from & 0x4924924924924924UL)) << 2;
-                allprime = smallprimes[digitsum];
+    if ((file = fopen(path, "r"))) {
+        if (fseek(file, summary->covers, SEEK_SET) == 0) {
+            while (fgets(line, sizeof(line), file) && strchr(line, '\n')) {
+                added |= addLedgerLine(summary, line);
+                summary->covers += strlen(line);
             }
         }
+        fclose(file);
+    }
+    return added;
+}
 
-        // if quick tests passed then try other bases
-        if (allprime) {
-METRIC(gate16)
-            // check other bases starting at the largest since it will have fewest digits
-            uint32_t r = radix;
-            while (allprime && r > 2) {
-                // check if the sum of digits in the base is prime
-                allprime = sumDigitsIsPrime(from, r);
-                r--;
-            }
-            if (allprime) {
-METRIC(sums)
-                if (isPrime(from)) {
-METRIC(primes)
-                    return from;
+
+// read the ledger summary then add the lines appended to the ledger since it was written
+static void readLedger(const char *path, LedgerSummary *summary) {
+    char name[PATH_MAX];
+    char line[4096];
+    uint64_t start, end, value;
+    uint32_t version, radix;
+    FILE *file;
+
+    memset(summary, 0, sizeof(*summary));
+
+    // read the summary (if it is missing or unreadable the whole ledger is read)
+    snprintf(name, sizeof(name), "%s.summary", path);
+    if ((file = fopen(name, "r"))) {
+        if (fscanf(file, "ds ledger summary %u\n", &version) == 1 && version == LEDGER_VERSION &&
+            fscanf(file, "covers %lu\n", &value) == 1) {
+            summary->covers = value;
+            while (fgets(line, sizeof(line), file)) {
+                if (sscanf(line, "range %lu %lu", &start, &end) == 2) {
+                    addLedgerRange(summary, start, end);
+                } else if (sscanf(line, "best %u %lu", &radix, &value) == 2 && radix <= 50) {
+                    summary->best[radix] = value;
                 }
             }
         }
+        fclose(file);
+    }
 
-        // go to next value
-        from += 4;
+    // add the complete lines after it
+    readLedgerLines(path, summary);
+}
 
-METRIC(checks)
-        // do a quick check for base 2
-        digitsum = _mm_popcnt_u64(from);
-        allprime = smallprimes[digitsum];
-        if (allprime && radix >= 4) {
-METRIC(gate2)
-            // do a quick check for base 4
-            digitsum = _mm_popcnt_u64(from & 0x5555555555555555UL);
-            digitsum += (_mm_popcnt_u64(from & 0xAAAAAAAAAAAAAAAAUL)) << 1;
-            allprime = smallprimes[digitsum];
-            if (allprime && radix >= 8) {
-METRIC(gate4)
-                // do a quick check for base 8
-                digitsum = _mm_popcnt_u64(from & 0x9249249249249249UL);
-                digitsum += (_mm_popcnt_u64(from & 0x2492492492492492UL)) << 1;
-                digitsum += (_mm_popcnt_u64(from & 0x4924924924924924UL)) << 2;
-                allprime = smallprimes[digitsum];
-            }
+
+// write the ledger summary
+// (written to a temporary file and renamed so readers never see a partial one)
+static void writeLedgerSummary(const char *path, const LedgerSummary *summary) {
+    char name[PATH_MAX];
+    char temp[PATH_MAX];
+    FILE *file;
+
+    snprintf(name, sizeof(name), "%s.summary", path);
+    snprintf(temp, sizeof(temp), "%s.summary.%d", path, (int32_t)getpid());
+    if (!(file = fopen(temp, "w"))) {
+        fprintf(stderr, "Fatal: cannot create ledger summary %s\n", temp);
+        exit(EXIT_FAILURE);
+    }
+    fprintf(file, "ds ledger summary %u\ncovers %lu\n", LEDGER_VERSION, summary->covers);
+    for (uint32_t i = 0; i < summary->count; i++) {
+        fprintf(file, "range %lu %lu\n", summary->ranges[i].start, summary->ranges[i].end);
+    }
+    for (uint32_t r = 2; r <= 50; r++) {
+        if (summary->best[r]) {
+            fprintf(file, "best %u %lu\n", r, summary->best[r]);
+        }
+    }
+    if (ferror(file) || fclose(file) != 0 || rename(temp, name) != 0) {
+        fprintf(stderr, "Fatal: cannot write ledger summary %s\n", name);
+        exit(EXIT_FAILURE);
+    }
+}
+
+
+// append the completed search to the ledger and update its summary
+// (the ledger is locked so searches completing together append and summarise in turn)
+void appendLedger(const char *path, const uint64_t start, const uint64_t end, const uint32_t minradix, const uint32_t maxradix,
+                  const uint64_t nanos) {
+    LedgerSummary summary;
+    char line[4096];
+    char last = '\n';
+    struct stat status;
+    int32_t length, fd;
+
+    // build the line with the values found and its CRC
+    length = snprintf(line, sizeof(line), "D %lu %lu %u %u %lu", start, end, minradix, maxradix, nanos);
+    for (uint32_t r = minradix; r <= maxradix; r++) {
+        if (resultValues[r]) {
+            length += snprintf(line + length, sizeof(line) - length, " %u:%lu", r, resultValues[r]);
         }
+    }
+    length += snprintf(line + length, sizeof(line) - length, " ");
+    length += snprintf(line + length, sizeof(line) - length, "#%08x\n", ledgerCrc(line, length));
 
-        // if quick tests passed then try other bases
-        if (allprime) {
-METRIC(gate16)
-            // check other bases starting at the largest since it will have fewest digits
-            uint32_t r = radix;
-            while (allprime && r > 2) {
-                // check if the sum of digits in the base is prime
-                allprime = sumDigitsIsPrime(from, r);
-                r--;
-            }
-            if (allprime) {
-METRIC(sums)
-                if (isPrime(from)) {
-METRIC(primes)
-                    return from;
-                }
+    // append it ending any line torn by a crash first so it cannot corrupt this one
+    if ((fd = open(path, O_WRONLY | O_APPEND | O_CREAT, 0644)) < 0 || flock(fd, LOCK_EX) != 0 || fstat(fd, &status) != 0) {
+        fprintf(stderr, "Fatal: cannot open ledger %s\n", path);
+        exit(EXIT_FAILURE);
+    }
+    if (status.st_size > 0) {
+        int32_t reader = open(path, O_RDONLY);
+        if (reader >= 0) {
+            if (pread(reader, &last, 1, status.st_size - 1) != 1) {
+                last = '\n';
             }
+            close(reader);
         }
+    }
+    if ((last != '\n' && write(fd, "\n", 1) != 1) || write(fd, line, length) != length || fsync(fd) != 0) {
+        fprintf(stderr, "Fatal: cannot append to ledger %s\n", path);
+        exit(EXIT_FAILURE);
+    }
 
-        // go to next value
-        from += 2;
+    // bring the summary up to date while still holding the lock
+    readLedger(path, &summary);
+    writeLedgerSummary(path, &summary);
+    free(summary.ranges);
+    close(fd);
+}
 
-METRIC(checks)
-        // do a quick check for base 2
-        digitsum = _mm_popcnt_u64(from);
-        allprime = smallprimes[digitsum];
-        if (allprime && radix >= 4) {
-METRIC(gate2)
-            // do a quick check for base 4
-            digitsum = _mm_popcnt_u64(from & 0x5555555555555555UL);
-            digitsum += (_mm_popcnt_u64(from & 0xAAAAAAAAAAAAAAAAUL)) << 1;
-            allprime = smallprimes[digitsum];
-            if (allprime && radix >= 8) {
-METRIC(gate4)
-                // do a quick check for base 8
-                digitsum = _mm_popcnt_u64(from & 0x9249249249249249UL);
-                digitsum += (_mm_popcnt_u64(from & 0x2492492492492492UL)) << 1;
-                digitsum += (_mm_popcnt_u64(from & 0x4924924924924924UL)) << 2;
-                allprime = smallprimes[digitsum];
-            }
+
+// display the smallest value found for each n (largest n first)
+static void displayLedgerBest(const LedgerSummary *summary) {
+    for (uint32_t r = 50; r >= 2; r--) {
+        if (summary->best[r]) {
+            displayResult(summary->best[r], r);
         }
+    }
+}
 
-        // if quick tests passed then try other bases
-        if (allprime) {
-METRIC(gate16)
-            // check other bases starting at the largest since it will have fewest digits
-            uint32_t r = radix;
-            while (allprime && r > 2) {
-                // check if the sum of digits in the base is prime
-                allprime = sumDigitsIsPrime(from, r);
-                r--;
-            }
-            if (allprime) {
-METRIC(sums)
-                if (isPrime(from)) {
-METRIC(primes)
-                    return from;
-                }
+
+// display the smallest value found for each n each time a search is appended to the ledger
+// (the ledger is watched with inotify so nothing is done between searches completing and only
+// the lines appended are read)
+static int32_t watchLedger(const char *path, LedgerSummary *summary) {
+    char events[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    int32_t fd;
+
+    if ((fd = inotify_init1(IN_CLOEXEC)) < 0 || inotify_add_watch(fd, path, IN_MODIFY) < 0) {
+        fprintf(stderr, "Fatal: cannot watch ledger %s\n", path);
+        exit(EXIT_FAILURE);
+    }
+
+    while (true) {
+        // clear the screen and display the table
+        printf("\033[H\033[2JPrimes\tValues\n");
+        displayLedgerBest(summary);
+        fflush(stdout);
+
+        // wait until lines that change the table are appended
+        do {
+            if (read(fd, events, sizeof(events)) <= 0) {
+                close(fd);
+                return EXIT_FAILURE;
             }
+        } while (!readLedgerLines(path, summary));
+    }
+}
+
+
+// answer a query about the ledger for the scripts
+//     next size - number of the first block of the given size not searched
+//     best      - smallest value found for each n (largest n first)
+//     ranges    - ranges searched
+//     watch     - best redisplayed each time a search completes
+int32_t queryLedger(const char *path, const char *query, const int32_t argc, char **argv) {
+    LedgerSummary summary;
+    uint64_t size;
+    int32_t status = EXIT_SUCCESS;
+
+    readLedger(path, &summary);
+    if (strcmp(query, "next") == 0 && argc == 1 && (size = strtoul(argv[0], NULL, 10)) > 0) {
+        // blocks run from number * size to (number + 1) * size so the first block not covered
+        // ends after the first range
+        if (summary.count == 0 || summary.ranges[0].start > 0) {
+            printf("0\n");
+        } else {
+            printf("%lu\n", summary.ranges[0].end / size);
+        }
+    } else if (strcmp(query, "best") == 0 && argc == 0) {
+        displayLedgerBest(&summary);
+    } else if (strcmp(query, "watch") == 0 && argc == 0) {
+        status = watchLedger(path, &summary);
+    } else if (strcmp(query, "ranges") == 0 && argc == 0) {
+        for (uint32_t i = 0; i < summary.count; i++) {
+            printf("%lu %lu\n", summary.ranges[i].start, summary.ranges[i].end);
+        }
+    } else {
+        fprintf(stderr, "Unknown ledger query %s (expected next size, best, ranges or watch)\n", query);
+        status = EXIT_FAILURE;
+    }
+    free(summary.ranges);
+
+    return status;
+}
+
+
+// microbenchmark repetitions (after the warm-up runs) and warm-up runs
+#define BENCH_REPS 10
+#define BENCH_WARMUP 2
+
+
+// number of inputs for each per value kernel and values in the range each range kernel checks
+#define BENCH_INPUTS (1U << 16)
+#define BENCH_RANGE (1UL << 24)
+
+
+// first value of the fixed input sets (a typical block) and the seed used to spread inputs over 2^40 above it
+#define BENCH_BASE 1000000000000UL
+#define BENCH_SEED 0x9E3779B97F4A7C15UL
+
+
+// fixed input sets: random odd values and primes among them
+static uint64_t benchOdd[BENCH_INPUTS];
+static uint64_t benchPrimes[BENCH_INPUTS];
+
+
+// kernel timed by the microbenchmark for the given radix returning a value depending on every result
+typedef uint64_t (*BenchKernel)(const uint32_t radix);
+
+
+// fill the fixed input sets from a xorshift generator with a fixed seed so every run times the same values
+void initBenchInputs(void) {
+    uint64_t state = BENCH_SEED;
+    uint64_t value = 0;
+    uint32_t primes = 0;
+
+    for (uint32_t i = 0; i < BENCH_INPUTS; i++) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        benchOdd[i] = (BENCH_BASE + (state >> 24)) | 1;
+    }
+
+    // the primes are the next prime after each input
+    for (uint32_t i = 0; primes < BENCH_INPUTS; i++) {
+        for (value = benchOdd[i]; !isPrime(value); value += 2) {
+        }
+        benchPrimes[primes++] = value;
+    }
+}
+
+
+// time sumDigits in the given radix
+uint64_t benchSumDigits(const uint32_t radix) {
+    uint64_t sink = 0;
+
+    for (uint32_t i = 0; i < BENCH_INPUTS; i++) {
+        sink += sumDigits(benchOdd[i], radix);
+    }
+    return sink;
+}
+
+
+// time sumDigitsIsPrime in the given radix
+uint64_t benchSumDigitsIsPrime(const uint32_t radix) {
+    uint64_t sink = 0;
+
+    for (uint32_t i = 0; i < BENCH_INPUTS; i++) {
+        sink += sumDigitsIsPrime(benchOdd[i], radix);
+    }
+    return sink;
+}
+
+
+// time the chain of power of 2 radix gates used by the kernel for the given radix
+uint64_t benchGates(const uint32_t radix) {
+    const uint32_t gates = gateLimit(radix);
+    uint64_t sink = 0;
+
+    for (uint32_t i = 0; i < BENCH_INPUTS; i++) {
+        const uint64_t value = benchOdd[i];
+
+        sink += powerSumIsPrime(value, 0xFFFFFFFFFFFFFFFFUL, 1) &&
+                (gates < 4 || powerSumIsPrime(value, 0x5555555555555555UL, 2)) &&
+                (gates < 8 || powerSumIsPrime(value, 0x9249249249249249UL, 3)) &&
+                (gates < 16 || powerSumIsPrime(value, 0x1111111111111111UL, 4)) &&
+                (gates < 32 || powerSumIsPrime(value, 0x1084210842108421UL, 5));
+    }
+    return sink;
+}
+
+
+// time the strong pseudoprime test to base 2 on odd values
+uint64_t benchSpsp(const uint32_t radix) {
+    montgomery m;
+    uint64_t sink = 0;
+
+    (void)radix;
+    for (uint32_t i = 0; i < BENCH_INPUTS; i++) {
+        montinit(&m, benchOdd[i]);
+        sink += spsp(&m, 2);
+    }
+    return sink;
+}
+
+
+// time isPrime on odd values (most rejected by trial division)
+uint64_t benchIsPrimeOdd(const uint32_t radix) {
+    uint64_t sink = 0;
+
+    (void)radix;
+    for (uint32_t i = 0; i < BENCH_INPUTS; i++) {
+        sink += isPrime(benchOdd[i]);
+    }
+    return sink;
+}
+
+
+// time isPrime on primes (the full Baillie-PSW test every time)
+uint64_t benchIsPrimePrimes(const uint32_t radix) {
+    uint64_t sink = 0;
+
+    (void)radix;
+    for (uint32_t i = 0; i < BENCH_INPUTS; i++) {
+        sink += isPrime(benchPrimes[i]);
+    }
+    return sink;
+}
+
+
+// kernel timed by benchRange
+static uint32_t benchRangeKernel = KERNEL_SCALAR;
+
+
+// time a range kernel over the fixed range continuing after each value it finds
+uint64_t benchRange(const uint32_t radix) {
+    uint64_t from = BENCH_BASE;
+    uint64_t sink = 0;
+
+    while (from < BENCH_BASE + BENCH_RANGE) {
+        from = checkRangeWith(benchRangeKernel, from, BENCH_BASE + BENCH_RANGE - 1, radix);
+        sink += from;
+        from++;
+    }
+    return sink;
+}
+
+
+// compare times for sorting
+static int32_t compareBenchTimes(const void *a, const void *b) {
+    const double x = *(const double *)a;
+    const double y = *(const double *)b;
+
+    return (x > y) - (x < y);
+}
+
+
+// time a kernel for the given radix on the given number of operations displaying the
+// median, minimum, maximum and relative standard deviation of the ns/op and the median cycles/op
+void benchmark(const char *name, const uint32_t radix, BenchKernel kernel, const uint64_t ops) {
+    double nanos[BENCH_REPS];
+    double cycles[BENCH_REPS];
+    double mean = 0.0;
+    double deviation = 0.0;
+    uint64_t sink = 0;
+    uint64_t started = 0;
+    uint64_t ticks = 0;
+    uint32_t i = 0;
+    char label[64];
+
+    // warm up the caches, branch predictors and any tables the kernel builds
+    for (i = 0; i < BENCH_WARMUP; i++) {
+        sink += kernel(radix);
+    }
+
+    for (i = 0; i < BENCH_REPS; i++) {
+        started = monotonicNanos();
+        ticks = __rdtsc();
+        sink += kernel(radix);
+        cycles[i] = (double)(__rdtsc() - ticks) / ops;
+        nanos[i] = (double)(monotonicNanos() - started) / ops;
+        mean += nanos[i] / BENCH_REPS;
+    }
+    for (i = 0; i < BENCH_REPS; i++) {
+        deviation += (nanos[i] - mean) * (nanos[i] - mean) / BENCH_REPS;
+    }
+    qsort(nanos, BENCH_REPS, sizeof(double), compareBenchTimes);
+    qsort(cycles, BENCH_REPS, sizeof(double), compareBenchTimes);
+
+    if (radix) {
+        snprintf(label, sizeof(label), "%s/%u", name, radix);
+    } else {
+        snprintf(label, sizeof(label), "%s", name);
+    }
+    printf("%-24s %10lu %10.2f %10.2f %10.2f %7.1f%% %10.2f\n", label, ops, nanos[BENCH_REPS / 2], nanos[0],
+           nanos[BENCH_REPS - 1], mean ? 100.0 * sqrt(deviation) / mean : 0.0, cycles[BENCH_REPS / 2]);
+
+    // keep the results from being optimized away
+    if (sink == UINT64_MAX) {
+        printf("\n");
+    }
+}
+
+
+// time each kernel on the fixed input sets
+void microbenchmark(void) {
+    const uint32_t kernels[] = { KERNEL_VECTOR, KERNEL_BATCH, KERNEL_LOWBIT, KERNEL_SIEVE };
+    const char *scalarNames[] = { "checkRangeSub16", "checkRange16To31", "checkRange32Plus" };
+    const uint32_t scalarRadices[] = { 13, 23, 40 };
+    const uint32_t gateRadices[] = { 3, 4, 8, 16, 32 };
+    uint32_t r = 0;
+    char label[32];
+
+    (void) setlocale(LC_NUMERIC, "en_US.utf8");
+    initPrimes(50);
+    initDigitSums(50, digitSumBudget(), 1);
+    initBenchInputs();
+    printf("Microbenchmark: %u warm-up runs then %u timed runs, %u inputs from %'lu, ranges of %'lu values\n",
+           BENCH_WARMUP, BENCH_REPS, BENCH_INPUTS, BENCH_BASE, BENCH_RANGE);
+    printf("Cycles are time stamp counter cycles\n");
+    printf("%-24s %10s %10s %10s %10s %8s %10s\n", "Kernel/radix", "ops", "ns/op", "min", "max", "stddev", "cycles/op");
+
+    // digit sums in each radix that is not a power of 2
+    for (r = 3; r <= 50; r++) {
+        if ((r & (r - 1)) != 0) {
+            benchmark("sumDigits", r, benchSumDigits, BENCH_INPUTS);
+        }
+    }
+    for (r = 3; r <= 50; r++) {
+        if ((r & (r - 1)) != 0) {
+            benchmark("sumDigitsIsPrime", r, benchSumDigitsIsPrime, BENCH_INPUTS);
         }
+    }
 
-        // go to next value
-        from += 4;
-
-METRIC(checks)
-        // do a quick check for base 2
-        digitsum = _mm_popcnt_u64(from);
-        allprime = smallprimes[digitsum];
-        if (allprime && radix >= 4) {
-METRIC(gate2)
-            // do a quick check for base 4
-            digitsum = _mm_popcnt_u64(from & 0x5555555555555555UL);
-            digitsum += (_mm_popcnt_u64(from & 0xAAAAAAAAAAAAAAAAUL)) << 1;
-            allprime = smallprimes[digitsum];
-            if (allprime && radix >= 8) {
-METRIC(gate4)
-                // do a quick check for base 8
-                digitsum = _mm_popcnt_u64(from & 0x9249249249249249UL);
-                digitsum += (_mm_popcnt_u64(from & 0x2492492492492492UL)) << 1;
-                digitsum += (_mm_popcnt_u64(from & 0x4924924924924924UL)) << 2;
-                allprime = smallprimes[digitsum];
-            }
+    // power of 2 gate chains and primality
+    for (r = 0; r < sizeof(gateRadices) / sizeof(gateRadices[0]); r++) {
+        benchmark("gates", gateRadices[r], benchGates, BENCH_INPUTS);
+    }
+    benchmark("spsp", 2, benchSpsp, BENCH_INPUTS);
+    benchmark("isPrime odd", 0, benchIsPrimeOdd, BENCH_INPUTS);
+    benchmark("isPrime primes", 0, benchIsPrimePrimes, BENCH_INPUTS);
+
+    // range kernels per value in the range (the scalar kernels on the mod 30 wheel they search with)
+    initWheel(50, 30);
+    benchRangeKernel = KERNEL_SCALAR;
+    for (r = 0; r < sizeof(scalarRadices) / sizeof(scalarRadices[0]); r++) {
+        benchmark(scalarNames[r], scalarRadices[r], benchRange, BENCH_RANGE);
+    }
+    initWheel(50, 2310);
+    initLowbit();
+    for (r = 0; r < sizeof(kernels) / sizeof(kernels[0]); r++) {
+#ifndef VECTOR_KERNEL
+        if (kernels[r] == KERNEL_VECTOR) {
+            continue;
         }
+#endif
+        benchRangeKernel = kernels[r];
+        snprintf(label, sizeof(label), "checkRange %s", radixKernelNames[kernels[r]]);
+        benchmark(label, 40, benchRange, BENCH_RANGE);
+    }
 
-        // if quick tests passed then try other bases
-        if (allprime) {
-METRIC(gate16)
-            // check other bases starting at the largest since it will have fewest digits
-            uint32_t r = radix;
-            while (allprime && r > 2) {
-                // check if the sum of digits in the base is prime
-                allprime = sumDigitsIsPrime(from, r);
-                r--;
-            }
-            if (allprime) {
-METRIC(sums)
-                if (isPrime(from)) {
-METRIC(primes)
-                    return from;
-                }
-            }
-        }
+    freeLowbit();
+    freeDigitSums();
+    freePrimes();
+}
 
-        // go to next value
-        from += 2;
 
-METRIC(checks)
-        // do a quick check for base 2
-        digitsum = _mm_popcnt_u64(from);
-        allprime = smallprimes[digitsum];
-        if (allprime && radix >= 4) {
-METRIC(gate2)
-            // do a quick check for base 4
-            digitsum = _mm_popcnt_u64(from & 0x5555555555555555UL);
-            digitsum += (_mm_popcnt_u64(from & 0xAAAAAAAAAAAAAAAAUL)) << 1;
-            allprime = smallprimes[digitsum];
-            if (allprime && radix >= 8) {
-METRIC(gate4)
-                // do a quick check for base 8
-                digitsum = _mm_popcnt_u64(from & 0x9249249249249249UL);
-                digitsum += (_mm_popcnt_u64(from & 0x2492492492492492UL)) << 1;
-                digitsum += (_mm_popcnt_u64(from & 0x4924924924924924UL)) << 2;
-                allprime = smallprimes[digitsum];
-            }
-        }
+// seconds each thread searches for in a scaling run, values timed to calibrate it and the search
+// start and bases (a range above every value found so far so the whole range is searched)
+#define SCALING_SECONDS 3
+#define SCALING_CALIBRATE (1UL << 27)
+#define SCALING_START 1000000000000UL
+#define SCALING_MINBASE 40
+#define SCALING_MAXBASE 50
 
-        // if quick tests passed then try other bases
-        if (allprime) {
-METRIC(gate16)
-            // check other bases starting at the largest since it will have fewest digits
-            uint32_t r = radix;
-            while (allprime && r > 2) {
-                // check if the sum of digits in the base is prime
-                allprime = sumDigitsIsPrime(from, r);
-                r--;
-            }
-            if (allprime) {
-METRIC(sums)
-                if (isPrime(from)) {
-METRIC(primes)
-                    return from;
-                }
-            }
-        }
 
-        // go to next value
-        from += 4;
+// scaling report file version (bump if the format changes)
+#define SCALING_VERSION 1
 
-METRIC(checks)
-        // do a quick check for base 2
-        digitsum = _mm_popcnt_u64(from);
-        allprime = smallprimes[digitsum];
-        if (allprime && radix >= 4) {
-METRIC(gate2)
-            // do a quick check for base 4
-            digitsum = _mm_popcnt_u64(from & 0x5555555555555555UL);
-            digitsum += (_mm_popcnt_u64(from & 0xAAAAAAAAAAAAAAAAUL)) << 1;
-            allprime = smallprimes[digitsum];
-            if (allprime && radix >= 8) {
-METRIC(gate4)
-                // do a quick check for base 8
-                digitsum = _mm_popcnt_u64(from & 0x9249249249249249UL);
-                digitsum += (_mm_popcnt_u64(from & 0x2492492492492492UL)) << 1;
-                digitsum += (_mm_popcnt_u64(from & 0x4924924924924924UL)) << 2;
-                allprime = smallprimes[digitsum];
-            }
-        }
 
-        // if quick tests passed then try other bases
-        if (allprime) {
-METRIC(gate16)
-            // check other bases starting at the largest since it will have fewest digits
-            uint32_t r = radix;
-            while (allprime && r > 2) {
-                // check if the sum of digits in the base is prime
-                allprime = sumDigitsIsPrime(from, r);
-                r--;
-            }
-            if (allprime) {
-METRIC(sums)
-                if (isPrime(from)) {
-METRIC(primes)
-                    return from;
-                }
-            }
-        }
+// result of a scaling run
+typedef struct {
+    uint32_t threads;       // search threads
+    uint32_t siblings;      // threads sharing a core with another thread (SMT)
+    uint64_t values;        // values searched
+    uint64_t nanos;         // time taken
+} ScalingRun;
 
-        // go to next value
-        from += 6;
 
-METRIC(checks)
-        // do a quick check for base 2
-        digitsum = _mm_popcnt_u64(from);
-        allprime = smallprimes[digitsum];
-        if (allprime && radix >= 4) {
-METRIC(gate2)
-            // do a quick check for base 4
-            digitsum = _mm_popcnt_u64(from & 0x5555555555555555UL);
-            digitsum += (_mm_popcnt_u64(from & 0xAAAAAAAAAAAAAAAAUL)) << 1;
-            allprime = smallprimes[digitsum];
-            if (allprime && radix >= 8) {
-METRIC(gate4)
-                // do a quick check for base 8
-                digitsum = _mm_popcnt_u64(from & 0x9249249249249249UL);
-                digitsum += (_mm_popcnt_u64(from & 0x2492492492492492UL)) << 1;
-                digitsum += (_mm_popcnt_u64(from & 0x4924924924924924UL)) << 2;
-                allprime = smallprimes[digitsum];
-            }
-        }
+// read a CPU topology number from sysfs returning -1 if it is not available
+static int32_t readTopology(const int32_t cpu, const char *name) {
+    char path[128];
+    int32_t value = -1;
+    FILE *file;
 
-        // if quick tests passed then try other bases
-        if (allprime) {
-METRIC(gate16)
-            // check other bases starting at the largest since it will have fewest digits
-            uint32_t r = radix;
-            while (allprime && r > 2) {
-                // check if the sum of digits in the base is prime
-                allprime = sumDigitsIsPrime(from, r);
-                r--;
-            }
-            if (allprime) {
-METRIC(sums)
-                if (isPrime(from)) {
-METRIC(primes)
-                    return from;
-                }
-            }
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/%s", cpu, name);
+    if ((file = fopen(path, "r"))) {
+        if (fscanf(file, "%d", &value) != 1) {
+            value = -1;
         }
+        fclose(file);
+    }
+    return value;
+}
 
-        // go to next value
-        from += 2;
 
-METRIC(checks)
-        // do a quick check for base 2
-        digitsum = _mm_popcnt_u64(from);
-        allprime = smallprimes[digitsum];
-        if (allprime && radix >= 4) {
-METRIC(gate2)
-            // do a quick check for base 4
-            digitsum = _mm_popcnt_u64(from & 0x5555555555555555UL);
-            digitsum += (_mm_popcnt_u64(from & 0xAAAAAAAAAAAAAAAAUL)) << 1;
-            allprime = smallprimes[digitsum];
-            if (allprime && radix >= 8) {
-METRIC(gate4)
-                // do a quick check for base 8
-                digitsum = _mm_popcnt_u64(from & 0x9249249249249249UL);
-                digitsum += (_mm_popcnt_u64(from & 0x2492492492492492UL)) << 1;
-                digitsum += (_mm_popcnt_u64(from & 0x4924924924924924UL)) << 2;
-                allprime = smallprimes[digitsum];
-            }
+// order the logical CPUs this process may run on with one per physical core first followed by
+// their SMT siblings returning the number of logical CPUs and the number of cores
+uint32_t orderCpus(int32_t *order, uint32_t *cores) {
+    int32_t package[CPU_SETSIZE];
+    int32_t core[CPU_SETSIZE];
+    int32_t siblings[CPU_SETSIZE];
+    uint32_t count = 0;
+    uint32_t extra = 0;
+    uint32_t i = 0;
+    cpu_set_t allowed;
+
+    *cores = 0;
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+        order[0] = 0;
+        *cores = 1;
+        return 1;
+    }
+    for (int32_t cpu = 0; cpu < CPU_SETSIZE && count < MAX_THREADS; cpu++) {
+        if (!CPU_ISSET(cpu, &allowed)) {
+            continue;
         }
+        package[count] = readTopology(cpu, "physical_package_id");
+        core[count] = readTopology(cpu, "core_id");
 
-        // if quick tests passed then try other bases
-        if (allprime) {
-METRIC(gate16)
-            // check other bases starting at the largest since it will have fewest digits
-            uint32_t r = radix;
-            while (allprime && r > 2) {
-                // check if the sum of digits in the base is prime
-                allprime = sumDigitsIsPrime(from, r);
-                r--;
-            }
-            if (allprime) {
-METRIC(sums)
-                if (isPrime(from)) {
-METRIC(primes)
-                    return from;
-                }
+        // a CPU on a core already listed is an SMT sibling
+        for (i = 0; i < *cores; i++) {
+            if (core[count] >= 0 && package[i] == package[count] && core[i] == core[count]) {
+                break;
             }
         }
-
-        // go to next value
-        from += 6;
+        if (i < *cores) {
+            siblings[extra++] = cpu;
+        } else {
+            package[*cores] = package[count];
+            core[*cores] = core[count];
+            order[(*cores)++] = cpu;
+        }
+        count++;
     }
+    memcpy(order + *cores, siblings, extra * sizeof(int32_t));
 
-    // not found
-    return to + 1;
+    return count;
 }
 
 
-// initialize fast prime lookup for digit sums
-void initPrimes(const uint32_t base) {
-    // calculate maximum number of digits in the given base
-    uint32_t number = ceil(log((double)ULLONG_MAX) / log((double)base));
+// time a search of the given number of values per thread on the given number of threads
+// (on the given number of cores and logical CPUs to count the threads sharing a core)
+ScalingRun scalingRun(const uint32_t threads, const uint64_t perThread, const uint32_t cores, const uint32_t cpus) {
+    const uint32_t placed = threads < cpus ? threads : cpus;
+    ScalingRun run = { .threads = threads };
+    uint64_t started = 0;
 
-    // calculate the largest digit sum
-    uint32_t largestds = number * (base - 1);
+    // each thread placed beyond the cores shares a core with one of the first threads
+    run.siblings = placed > cores ? 2 * (placed - cores) : 0;
+    run.values = perThread * threads;
+    started = monotonicNanos();
+    searchRange(SCALING_START, SCALING_START + run.values - 1, SCALING_MINBASE, SCALING_MAXBASE, threads);
+    run.nanos = monotonicNanos() - started + 1;
 
-    // allocate primes array
-    smallprimes = (bool *)calloc(largestds, sizeof(*smallprimes));
+    return run;
+}
 
-    // populate primes array
-    for (uint32_t i = 2; i < largestds; i++) {
-        smallprimes[i] = isPrime(i);
-    }
 
-    printf("Cached primes up to %u\n", largestds);
+// write the scaling runs as a JSON report
+void writeScalingReport(const char *path, const ScalingRun *runs, const uint32_t count, const uint32_t cores, const uint32_t cpus) {
+    const double base = (double)runs[0].values / runs[0].nanos / runs[0].threads;
+    char temp[PATH_MAX];
+    char model[256];
+    FILE *file;
+
+    snprintf(temp, sizeof(temp), "%s.tmp", path);
+    if (!(file = fopen(temp, "w"))) {
+        fprintf(stderr, "Fatal: cannot create report file %s\n", temp);
+        exit(EXIT_FAILURE);
+    }
+    cpuModel(model, sizeof(model));
+    fprintf(file, "{\n  \"version\": %u,\n  \"cpu\": ", SCALING_VERSION);
+    writeJsonString(file, model);
+    fprintf(file, ",\n  \"cores\": %u,\n  \"logical_cpus\": %u,\n  \"kernel\": ", cores, cpus);
+    writeJsonString(file, kernelName());
+    fprintf(file, ",\n  \"start\": %lu,\n  \"minbase\": %u,\n  \"maxbase\": %u,\n", SCALING_START, SCALING_MINBASE, SCALING_MAXBASE);
+    fprintf(file, "  \"runs\": [");
+    for (uint32_t i = 0; i < count; i++) {
+        const double rate = (double)runs[i].values / runs[i].nanos * 1e9;
+
+        fprintf(file, "%s\n    { \"threads\": %u, \"smt_threads\": %u, \"values\": %lu, \"seconds\": %.6f, ", i ? "," : "",
+                runs[i].threads, runs[i].siblings, runs[i].values, (double)runs[i].nanos / 1000000000);
+        fprintf(file, "\"values_per_second\": %.0f, \"per_thread\": %.0f, \"efficiency\": %.4f }",
+                rate, rate / runs[i].threads, rate / 1e9 / runs[i].threads / base);
+    }
+    fprintf(file, "\n  ]\n}\n");
+    if (ferror(file) || fclose(file) != 0 || rename(temp, path) != 0) {
+        fprintf(stderr, "Fatal: cannot write report file %s\n", path);
+        exit(EXIT_FAILURE);
+    }
 }
 
 
-// free fast prime lookup for digit sums
-void freePrimes() {
-    // free primes memory
-    free(smallprimes);
-    smallprimes = NULL;
+// time a fixed search on each of the given thread counts (or 1, 2, 4... up to the number of cores then
+// every logical CPU if none are given) pinning one thread per core before using SMT siblings
+// each thread searches the same number of values so a run with perfect scaling takes the same time
+int32_t scalingBenchmark(uint32_t *counts, uint32_t count, const char *reportfile) {
+    static int32_t order[MAX_THREADS];
+    ScalingRun runs[64];
+    uint64_t perThread = 0;
+    uint32_t cores = 0;
+    uint32_t cpus = 0;
+    uint32_t most = 1;
+    uint32_t i = 0;
+    double base = 0.0;
+    double rate = 0.0;
+
+    (void) setlocale(LC_NUMERIC, "en_US.utf8");
+    cpus = orderCpus(order, &cores);
+    threadCpus = order;
+    threadCpuCount = cpus;
+
+    // default to doubling the threads up to the cores then every logical CPU
+    if (count == 0) {
+        for (i = 1; i < cores; i *= 2) {
+            counts[count++] = i;
+        }
+        counts[count++] = cores;
+        if (cpus > cores) {
+            counts[count++] = cpus;
+        }
+    }
+    for (i = 0; i < count; i++) {
+        if (counts[i] < 1 || counts[i] > MAX_THREADS) {
+            fprintf(stderr, "Fatal: scaling thread counts must be in the range 1 to %u\n", MAX_THREADS);
+            exit(EXIT_FAILURE);
+        }
+        if (counts[i] > most) {
+            most = counts[i];
+        }
+    }
+
+    // set up the search as for a block from the scaling start
+    initPrimes(SCALING_MAXBASE);
+    initWheel(SCALING_MAXBASE, searchKernel == KERNEL_SCALAR ? 30 : 2310);
+    if (searchKernel == KERNEL_LOWBIT || searchKernel == KERNEL_SIEVE || searchKernel == KERNEL_AUTO) {
+        initLowbit();
+    }
+    initDigitSums(SCALING_MAXBASE, digitSumBudget(), most);
+    measureRadixCosts(SCALING_START, SCALING_MAXBASE);
+    if (searchKernel == KERNEL_AUTO) {
+        calibrateKernels(SCALING_START, SCALING_START + CALIBRATE_MIN, SCALING_MINBASE, SCALING_MAXBASE);
+    }
+
+    // size the work per thread from a single thread run (after one that warms up the tables and radix order)
+    scalingRun(1, SCALING_CALIBRATE, cores, cpus);
+    rate = (double)SCALING_CALIBRATE / scalingRun(1, SCALING_CALIBRATE, cores, cpus).nanos * 1e9;
+    perThread = ((uint64_t)(rate * SCALING_SECONDS) / CHUNK_SIZE + 2) * CHUNK_SIZE;
+    printf("Scaling benchmark on %u cores with %u logical CPUs, kernel %s, bases %u to %u\n", cores, cpus, kernelName(), SCALING_MINBASE, SCALING_MAXBASE);
+    printf("Each thread searches %'lu values from %'lu (about %u seconds)\n", perThread, SCALING_START, SCALING_SECONDS);
+    printf("Threads\tSMT\tSeconds\tValues/s\tPer thread\tEfficiency\n");
+
+    // time each thread count (SMT threads share a core with another search thread)
+    for (i = 0; i < count && i < sizeof(runs) / sizeof(runs[0]); i++) {
+        runs[i] = scalingRun(counts[i], perThread, cores, cpus);
+        rate = (double)runs[i].values / runs[i].nanos * 1e9;
+        if (i == 0) {
+            base = rate / runs[i].threads;
+        }
+        printf("%u\t%u\t%.2f\t%.0f\t%.0f\t%.1f%%\n", runs[i].threads, runs[i].siblings, (double)runs[i].nanos / 1000000000,
+               rate, rate / runs[i].threads, 100.0 * rate / runs[i].threads / base);
+    }
+    if (reportfile) {
+        writeScalingReport(reportfile, runs, i, cores, cpus);
+    }
+
+    threadCpus = NULL;
+    if (searchKernel == KERNEL_LOWBIT || searchKernel == KERNEL_SIEVE || searchKernel == KERNEL_AUTO) {
+        freeLowbit();
+    }
+    freeDigitSums();
+    freePrimes();
+
+    return EXIT_SUCCESS;
 }
 
 
 // validate command line arguments
-bool validateArguments(const int8_t *program, const uint64_t start, const uint64_t end, const uint32_t minradix, const uint32_t maxradix) {
+bool validateArguments(const int8_t *program, const uint64_t start, const uint64_t end, const uint32_t minradix, const uint32_t maxradix, const uint32_t threads) {
     if (minradix < 2 || minradix > 50 || maxradix < 2 || maxradix > 50) {
         fprintf(stderr, "%s: bases must be in the range 2 to 50\n", program);
         return false;
     }
 
+    if (threads < 1 || threads > MAX_THREADS) {
+        fprintf(stderr, "%s: threads must be in the range 1 to %u\n", program, MAX_THREADS);
+        return false;
+    }
+
     if (start > end) {
         fprintf(stderr, "%s: start must be less than end\n", program);
         return false;
@@ -1627,94 +5525,247 @@ int32_t main(int32_t argc, char **argv) {
     uint64_t start = 0UL;
     uint64_t end = 0UL;
     uint64_t current = 0UL;
+    uint64_t first = 0UL;
     uint32_t radix = 16;
+    uint32_t minradix = 16;
     uint32_t maxradix = 50;
     uint32_t maxmatch = 0;
+    uint32_t threads = 1;
+    int32_t opt = 0;
+    char *endptr = 0;
+    char *tablefile = NULL;
+    char *reportfile = NULL;
+    char *ledgerfile = NULL;
+    char *query = NULL;
+    char *boardfile = NULL;
+    char *statusfile = NULL;
+    bool allrecords = false;
+    bool scaling = false;
+    uint32_t counts[64];
+    uint32_t count = 0;
+    const struct option longOptions[] = {
+        { "scaling", no_argument, NULL, 'S' },
+        { NULL, 0, NULL, 0 }
+    };
+    uint64_t searched = 0;
+    uint64_t started = 0;
+    uint64_t elapsed = 0;
+
+    // decode options
+    while ((opt = getopt_long(argc, argv, "amBt:k:f:c:j:l:q:b:s:", longOptions, NULL)) != -1) {
+        switch (opt) {
+        case 't':
+            threads = strtoul(optarg, &endptr, 10);
+            break;
+        case 'k':
+            if (!selectKernel(optarg)) {
+                fprintf(stderr, "%s: unsupported kernel %s\n", argv[0], optarg);
+                exit(EXIT_FAILURE);
+            }
+            break;
+        case 'f':
+            tablefile = optarg;
+            break;
+        case 'c':
+            checkpoint.path = optarg;
+            break;
+        case 'j':
+            reportfile = optarg;
+            break;
+        case 'l':
+            ledgerfile = optarg;
+            break;
+        case 'q':
+            query = optarg;
+            break;
+        case 'b':
+            boardfile = optarg;
+            break;
+        case 's':
+            statusfile = optarg;
+            break;
+        case 'a':
+            allrecords = true;
+            break;
+        case 'm':
+            metricsEnabled = true;
+            break;
+        case 'B':
+            microbenchmark();
+            return EXIT_SUCCESS;
+        case 'S':
+            scaling = true;
+            break;
+        default:
+            fprintf(stderr, "Usage: %s [-a] [-m] [-t threads] [-k kernel] [-f tablefile] [-c checkpoint] [-j report] [-l ledger] [-b board] [-s status] start end minbase maxbase\n", argv[0]);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    // run the scaling benchmark on the thread counts given
+    if (scaling) {
+        while (optind < argc && count < sizeof(counts) / sizeof(counts[0])) {
+            counts[count++] = strtoul(argv[optind++], &endptr, 10);
+        }
+        return scalingBenchmark(counts, count, reportfile);
+    }
+
+    // answer a ledger query
+    if (query) {
+        if (!ledgerfile) {
+            fprintf(stderr, "%s: a ledger query needs -l ledger\n", argv[0]);
+            exit(EXIT_FAILURE);
+        }
+        (void) setlocale(LC_NUMERIC, "en_US.utf8");
+        return queryLedger(ledgerfile, query, argc - optind, argv + optind);
+    }
 
     // check command line
-    if (argc != 5) {
-        fprintf(stderr, "Usage: %s start end minbase maxbase\n", argv[0]);
+    if (argc - optind != 4) {
+        fprintf(stderr, "Usage: %s [-a] [-m] [-t threads] [-k kernel] [-f tablefile] [-c checkpoint] [-j report] [-l ledger] [-b board] [-s status] start end minbase maxbase\n", argv[0]);
         exit(EXIT_FAILURE);
     }
 
     // decode arguments
-    int32_t argnum = 1;
-    char *endptr = 0;
+    int32_t argnum = optind;
     start = strtoul(argv[argnum++], &endptr, 10);
     end = strtoul(argv[argnum++], &endptr, 10);
     radix = strtoul(argv[argnum++], &endptr, 10);
     maxradix = strtoul(argv[argnum++], &endptr, 10);
-    if (!validateArguments(argv[0], start, end, radix, maxradix)) {
+    if (!validateArguments(argv[0], start, end, radix, maxradix, threads)) {
         exit(EXIT_FAILURE);
     }
+    // in all records mode every base from 2 is searched (the low bases cost little since their
+    // values are found within the first few thousand candidates)
+    if (allrecords) {
+        radix = 2;
+    }
+    first = start;
+    minradix = radix;
 
     // set locale
     (void) setlocale(LC_NUMERIC, "en_US.utf8");   
 
-    // convert starting point to 30k+7
-    current = start;
-    current = (30 * (current / 30)) + 7;
-
     // initialize fast prime lookup for digit sums
     initPrimes(maxradix);
 
-    // initialize lookup for 4 digit sums
-    initDigitSums(maxradix, 4);
+    // initialize the wheel (the scalar kernels branch on each gate and predict them best on the
+    // regular pattern of the mod 30 wheel so they run faster on it than on the larger wheels)
+    initWheel(maxradix, searchKernel == KERNEL_SCALAR ? 30 : 2310);
+
+    // initialize the low bit tables
+    if (searchKernel == KERNEL_LOWBIT || searchKernel == KERNEL_SIEVE || searchKernel == KERNEL_AUTO) {
+        initLowbit();
+    }
+    current = start;
+
+    // initialize lookup for digit sums (mapped from the shared table file if one was given)
+    if (tablefile) {
+        loadDigitSums(tablefile, maxradix, digitSumBudget());
+    } else {
+        initDigitSums(maxradix, digitSumBudget(), threads);
+    }
     printf("Searching from %'lu to %'lu from base %u to %u\n", start, end, radix, maxradix);
+    printf("Search threads: %u\n", threads);
+    printf("Search kernel: %s\n", kernelName());
+
+    // share the values found with the other searches
+    if (boardfile) {
+        openBoard(boardfile);
+        printf("Shared board: %s\n", boardfile);
+    }
+
+    // resume from the checkpoint if there is one and stop cleanly on SIGINT/SIGTERM to write one
+    if (checkpoint.path) {
+        checkpoint.start = start;
+        checkpoint.end = end;
+        checkpoint.minradix = minradix;
+        checkpoint.maxradix = maxradix;
+        if (readCheckpoint()) {
+            if (checkpoint.resume > current) {
+                current = checkpoint.resume;
+            }
+            printf("Resuming from %'lu after %.2f seconds (checkpoint %s)\n", current, (double)checkpoint.elapsed / 1000000000, checkpoint.path);
+        }
+        struct sigaction action = { .sa_handler = requestStop };
+        sigemptyset(&action.sa_mask);
+        sigaction(SIGINT, &action, NULL);
+        sigaction(SIGTERM, &action, NULL);
+    }
 
     // start timing
-    struct timeval timer;
-    struct timeval next;
-    gettimeofday(&timer, 0);
+    started = monotonicNanos();
+    checkpoint.started = checkpoint.written = started;
 
-    // main search algo only supports 30k+7 values so check here for 3 and 5 if in requested range
-    // don't need to check 2 since digit sum in binary is not prime
+    // measure the cost of checking each radix for the adaptive radix order
+    measureRadixCosts(start, maxradix);
+
+    // choose the kernel for each radix
+    if (searchKernel == KERNEL_AUTO) {
+        calibrateKernels(start, end, radix, maxradix);
+    }
+
+    // main search algo only supports values on the wheel so check here for the primes below its first candidate
+    // if in requested range, don't need to check 2 since digit sum in binary is not prime
     start |= 1UL;
     if (start < 3) start = 3;
     uint64_t tinyend = end;
-    if (tinyend > 5) tinyend = 5;
+    if (tinyend > wheel.first - 1) tinyend = wheel.first - 1;
 
     while (start <= tinyend && radix <= maxradix) {
         uint32_t r = radix;
-        while (r > 2 && sumDigitsIsPrime(start, r)) {
+        while (r > 1 && smallprimes[sumDigits(start, r)]) {
             r--;
         }
-        if (r == 2) {
+        if (r == 1 && isPrime(start)) {
             displayResult(start, radix);
+            postBoard(radix, start);
             radix++;
         } else {
             start += 2;
         }
     }
 
-    // check each number in the supplied range for each radix
-    while (current <= end && radix <= maxradix) {
-        // ensure current is in form 30k+7
-        current = (30 * (current / 30)) + 7;
+    // count metrics, the checks by radix for the report and the batch statistics from here so the
+    // calibration above is left out
+    startMetrics(maxradix);
+    resetBatchStats();
 
-        // check the current range for the current radix
-        if (radix < 16) {
-            current = checkRangeSub16(current, end, radix);
-        } else {
-            if (radix < 32) {
-                current = checkRange16To31(current, end, radix);
-            } else {
-                current = checkRange32Plus(current, end, radix);
-            }
+    // publish the progress of each search thread while searching
+    if (statusfile) {
+        openStatus(statusfile, first, end, current, radix, maxradix, threads);
+    }
+
+    // search the supplied range for each radix
+    searched = searchRange(current, end, radix, maxradix, threads);
+    if (statusfile) {
+        closeStatus(searched > end);
+    }
+
+    // save the progress and exit without a time if the search was stopped
+    if (checkpoint.path) {
+        if (searched <= end) {
+            writeCheckpoint(searched);
+            printf("Stopped at %'lu, checkpoint written to %s\n", searched, checkpoint.path);
+            exit(EXIT_FAILURE);
         }
+        remove(checkpoint.path);
+    }
 
-        // if a ds(n) was found then display it
-        if (current <= end) {
-            displayResult(current, radix);
+    // display the smallest value found for each radix
+    // (passing over any radix the board shows was found below this search by another one)
+    while (radix <= maxradix && (atomic_load(&radixBest[radix]) <= end || solvedBelow(radix, first))) {
+        if (atomic_load(&radixBest[radix]) <= end) {
+            displayResult(atomic_load(&radixBest[radix]), radix);
             maxmatch = radix;
+        } else {
+            printf("%u: found below by another search\n", radix - 1);
         }
-
-        // try next radix
         radix++;
     }
 
     // check if no matches were found
-    if (current > end) {
+    if (current > end || radix <= maxradix) {
         if (maxmatch == 0) {
             printf("No matches after -- primes\n");
         } else {
@@ -1722,19 +5773,43 @@ int32_t main(int32_t argc, char **argv) {
         }
     }
 
-    // display elapsed time
-    gettimeofday(&next, 0);
-    uint32_t t = (next.tv_sec * 1000000 + next.tv_usec) - (timer.tv_sec * 1000000 + timer.tv_usec);
-    printf("Time: %.2f seconds\n", (double)t / 1000000);
+    // display the radix order the search finished with
+    displayRadixOrder(maxradix);
+
+    // display elapsed time (including any time before a checkpoint)
+    elapsed = monotonicNanos() - started + checkpoint.elapsed;
+    printf("Time: %.2f seconds\n", (double)elapsed / 1000000000);
+
+    // write the report
+    if (reportfile) {
+        writeReport(reportfile, first, end, minradix, maxradix, threads, elapsed);
+    }
+
+    // record the completed search in the ledger
+    if (ledgerfile) {
+        appendLedger(ledgerfile, first, end, minradix, maxradix, elapsed);
+    }
+
+    // output batch kernel throughput if any radix was searched with it
+    if (kernelUsed(KERNEL_BATCH, minradix, maxradix)) {
+        displayBatchStats();
+    }
 
     // display metrics
-#ifdef METRICS
-    printf("Checks: %'lu\nSub16: %'lu\nPlus16: %'lu\nPlus32: %'lu\n", checks, sub16, plus16, plus32);
-    printf("Gate2:  %'lu\nGate4:  %'lu\nGate8:  %'lu\nGate16: %'lu\nGate32: %'lu\nSums: %'lu\nPrimes: %'lu\n", gate2, gate4, gate8, gate16, gate32, sums, primes);
-#endif
+    if (metricsEnabled) {
+        displayMetrics(maxradix);
+        if (atomic_load(&lowbit.built)) {
+            printf("Low bit tables built: %'lu\n", atomic_load(&lowbit.built));
+        }
+    }
+
+    // free low bit tables
+    if (searchKernel == KERNEL_LOWBIT || searchKernel == KERNEL_SIEVE || searchKernel == KERNEL_AUTO) {
+        freeLowbit();
+    }
 
     // free digit sums lookup
-    freeDigitSums(maxradix);
+    freeDigitSums();
 
     // free fast prime lookup
     freePrimes();